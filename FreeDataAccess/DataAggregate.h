@@ -0,0 +1,596 @@
+#pragma once
+
+#include "DataBox.h"
+#include "DataThreadPool.h"
+#include "DataSimd.h"
+#include <bitset>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/// <summary>
+/// <para>DataAggregate::countIf()ŒlƔr@</para>
+/// </summary>
+enum class DataCompare
+{
+	EQUAL,
+	NOT_EQUAL,
+	LESS,
+	LESS_EQUAL,
+	GREATER,
+	GREATER_EQUAL
+};
+
+/// <summary>
+/// <para>Wv̌</para>
+/// <para>sum͎Ȃdouble, tȂint64_t, Ȃuint64_tő킹</para>
+/// <para>count=0̏ꍇAmin͌^̍ől, max͌^̍ŏlɂȂ</para>
+/// </summary>
+template<typename T>
+struct DataStats
+{
+	using Sum = std::conditional_t<std::is_floating_point_v<T>, double, std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+
+	size_t count;
+	Sum sum;
+	T min;
+	T max;
+
+	DataStats() : count(), sum(), min((std::numeric_limits<T>::max)()), max(std::numeric_limits<T>::lowest()) {}
+
+	/// <returns>ϒl (count=0̏ꍇ0)</returns>
+	double mean() const { return count == 0 ? 0.0 : static_cast<double>(sum) / static_cast<double>(count); }
+
+	/// <summary>
+	/// <para>ʂ͈̔͂̏Wvʂ킹</para>
+	/// </summary>
+	void merge(const DataStats& rhs)
+	{
+		count += rhs.count;
+		sum += rhs.sum;
+		if (rhs.min < min)
+			min = rhs.min;
+		if (max < rhs.max)
+			max = rhs.max;
+	}
+};
+
+/// <summary>
+/// <para>DataItem̔zADataBoxȉ̓ODataItemWv֐Q</para>
+/// <para>^T͔z̗vf̌^w肷 (DataItem͕̗LȂ̂ŁALXgƓ^̃TCYmF)</para>
+/// <para>floatEdouble̔zAVX2 (SSE2) ̖߂ŏWv</para>
+/// <para>int32_tEuint32_t̔zAVX2ꍇAVX2̖߂ŏWv (countIf()int32_t̂)</para>
+/// <para>ȊǑ^ƒ[1vfWv</para>
+/// <para>NaN܂܂ꍇminEmax͖߂ɂĈقȂ</para>
+/// </summary>
+class DataAggregate
+{
+public:
+	/// <summary>
+	/// <para>z̗vfEvEŏlEől߂</para>
+	/// </summary>
+	template<typename T>
+	static DataStats<T> stats(const T* data, size_t count);
+
+	/// <summary>
+	/// <para>DataItem̒lWv (złȂꍇ͗vf1̔zƂĈ)</para>
+	/// <para>^̃TCYقȂƗO</para>
+	/// </summary>
+	template<typename T>
+	static DataStats<T> stats(const DataItem& item);
+
+	/// <summary>
+	/// <para>boxgƂ̎qDataBoxAnameƂODataItemSďWv</para>
+	/// <para>qDataBoxƂ̏WvXbhv[ŕsčs</para>
+	/// <para>^̃TCYقȂDataItemƗO</para>
+	/// <para>Xbhv[̏̒Ă΂Ȃ</para>
+	/// </summary>
+	template<typename T>
+	static DataStats<T> stats(const DataBox& box, std::string_view name, DataThreadPool& pool = DataThreadPool::shared());
+
+	/// <returns>ẑAcompare̕@valueƔrĐ^ɂȂvf̐</returns>
+	template<typename T>
+	static size_t countIf(const T* data, size_t count, DataCompare compare, T value);
+
+	/// <summary>
+	/// <para>DataItem̒l̂Acompare̕@valueƔrĐ^ɂȂvf̐</para>
+	/// <para>^̃TCYقȂƗO</para>
+	/// </summary>
+	template<typename T>
+	static size_t countIf(const DataItem& item, DataCompare compare, T value);
+
+	/// <summary>
+	/// <para>boxgƂ̎qDataBoxAnameƂODataItem̒l̂Acompare̕@valueƔrĐ^ɂȂvf̐</para>
+	/// <para>stats()ƓsĐ</para>
+	/// </summary>
+	template<typename T>
+	static size_t countIf(const DataBox& box, std::string_view name, DataCompare compare, T value, DataThreadPool& pool = DataThreadPool::shared());
+
+	/// <returns>DataItem̒l̂Apredicate(T)trueԂvf̐</returns>
+	template<typename T, typename Predicate>
+	static size_t countIf(const DataItem& item, Predicate&& predicate);
+
+private:
+	template<typename T>
+	static const T* elements(const DataItem& item, size_t& count);
+
+	template<typename T>
+	static void scalarStats(const T* data, size_t first, size_t last, DataStats<T>& s);
+
+	template<typename T>
+	static size_t scalarCount(const T* data, size_t first, size_t last, DataCompare compare, T value);
+
+	template<typename Result, typename Function>
+	static Result walk(const DataBox& box, std::string_view name, Function& function);
+
+	template<typename Result, typename Function>
+	static Result subtree(const DataBox& box, std::string_view name, Function&& function, DataThreadPool& pool);
+
+	static size_t popcount(unsigned mask);
+};
+
+
+
+
+template<typename T>
+inline DataStats<T> DataAggregate::stats(const T* data, size_t count)
+{
+	static_assert(std::is_arithmetic_v<T>, "l^̂");
+
+	DataStats<T> s;
+	size_t i = 0;
+#if defined(FDA_SIMD_AVX2)
+	if constexpr (std::is_same_v<T, float>)
+	{
+		if (count >= 8)
+		{
+			// float̍v͐xۂdoubleɍLđ
+			__m256 mn = _mm256_loadu_ps(data);
+			__m256 mx = mn;
+			__m256d s0 = _mm256_setzero_pd();
+			__m256d s1 = _mm256_setzero_pd();
+			for (; i + 8 <= count; i += 8)
+			{
+				__m256 v = _mm256_loadu_ps(data + i);
+				mn = _mm256_min_ps(mn, v);
+				mx = _mm256_max_ps(mx, v);
+				s0 = _mm256_add_pd(s0, _mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+				s1 = _mm256_add_pd(s1, _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)));
+			}
+			float a[8], b[8];
+			double c[4];
+			_mm256_storeu_ps(a, mn);
+			_mm256_storeu_ps(b, mx);
+			_mm256_storeu_pd(c, _mm256_add_pd(s0, s1));
+			s.min = a[0];
+			s.max = b[0];
+			for (int j = 1; j < 8; ++j)
+			{
+				if (a[j] < s.min) s.min = a[j];
+				if (s.max < b[j]) s.max = b[j];
+			}
+			s.sum = (c[0] + c[1]) + (c[2] + c[3]);
+			s.count = i;
+		}
+	}
+	else if constexpr (std::is_same_v<T, double>)
+	{
+		if (count >= 8)
+		{
+			__m256d mn = _mm256_loadu_pd(data);
+			__m256d mx = mn;
+			__m256d s0 = _mm256_setzero_pd();
+			__m256d s1 = _mm256_setzero_pd();
+			for (; i + 8 <= count; i += 8)
+			{
+				__m256d v0 = _mm256_loadu_pd(data + i);
+				__m256d v1 = _mm256_loadu_pd(data + i + 4);
+				mn = _mm256_min_pd(mn, _mm256_min_pd(v0, v1));
+				mx = _mm256_max_pd(mx, _mm256_max_pd(v0, v1));
+				s0 = _mm256_add_pd(s0, v0);
+				s1 = _mm256_add_pd(s1, v1);
+			}
+			double a[4], b[4], c[4];
+			_mm256_storeu_pd(a, mn);
+			_mm256_storeu_pd(b, mx);
+			_mm256_storeu_pd(c, _mm256_add_pd(s0, s1));
+			s.min = a[0];
+			s.max = b[0];
+			for (int j = 1; j < 4; ++j)
+			{
+				if (a[j] < s.min) s.min = a[j];
+				if (s.max < b[j]) s.max = b[j];
+			}
+			s.sum = (c[0] + c[1]) + (c[2] + c[3]);
+			s.count = i;
+		}
+	}
+	else if constexpr (std::is_integral_v<T> && sizeof(T) == 4 && !std::is_same_v<T, bool>)
+	{
+		if (count >= 8)
+		{
+			// v64rbgɍLđ̂ŌӂꂵȂ
+			const __m256i* p = reinterpret_cast<const __m256i*>(data);
+			__m256i mn = _mm256_loadu_si256(p);
+			__m256i mx = mn;
+			__m256i s0 = _mm256_setzero_si256();
+			__m256i s1 = _mm256_setzero_si256();
+			for (; i + 8 <= count; i += 8)
+			{
+				__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+				if constexpr (std::is_signed_v<T>)
+				{
+					mn = _mm256_min_epi32(mn, v);
+					mx = _mm256_max_epi32(mx, v);
+					s0 = _mm256_add_epi64(s0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+					s1 = _mm256_add_epi64(s1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+				}
+				else
+				{
+					mn = _mm256_min_epu32(mn, v);
+					mx = _mm256_max_epu32(mx, v);
+					s0 = _mm256_add_epi64(s0, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(v)));
+					s1 = _mm256_add_epi64(s1, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(v, 1)));
+				}
+			}
+			T a[8], b[8];
+			typename DataStats<T>::Sum c[4];
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(a), mn);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(b), mx);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(c), _mm256_add_epi64(s0, s1));
+			s.min = a[0];
+			s.max = b[0];
+			for (int j = 1; j < 8; ++j)
+			{
+				if (a[j] < s.min) s.min = a[j];
+				if (s.max < b[j]) s.max = b[j];
+			}
+			s.sum = (c[0] + c[1]) + (c[2] + c[3]);
+			s.count = i;
+		}
+	}
+#elif defined(FDA_SIMD_SSE2)
+	if constexpr (std::is_same_v<T, float>)
+	{
+		if (count >= 4)
+		{
+			__m128 mn = _mm_loadu_ps(data);
+			__m128 mx = mn;
+			__m128d s0 = _mm_setzero_pd();
+			__m128d s1 = _mm_setzero_pd();
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128 v = _mm_loadu_ps(data + i);
+				mn = _mm_min_ps(mn, v);
+				mx = _mm_max_ps(mx, v);
+				s0 = _mm_add_pd(s0, _mm_cvtps_pd(v));
+				s1 = _mm_add_pd(s1, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+			}
+			float a[4], b[4];
+			double c[2];
+			_mm_storeu_ps(a, mn);
+			_mm_storeu_ps(b, mx);
+			_mm_storeu_pd(c, _mm_add_pd(s0, s1));
+			s.min = a[0];
+			s.max = b[0];
+			for (int j = 1; j < 4; ++j)
+			{
+				if (a[j] < s.min) s.min = a[j];
+				if (s.max < b[j]) s.max = b[j];
+			}
+			s.sum = c[0] + c[1];
+			s.count = i;
+		}
+	}
+	else if constexpr (std::is_same_v<T, double>)
+	{
+		if (count >= 4)
+		{
+			__m128d mn = _mm_loadu_pd(data);
+			__m128d mx = mn;
+			__m128d s0 = _mm_setzero_pd();
+			__m128d s1 = _mm_setzero_pd();
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128d v0 = _mm_loadu_pd(data + i);
+				__m128d v1 = _mm_loadu_pd(data + i + 2);
+				mn = _mm_min_pd(mn, _mm_min_pd(v0, v1));
+				mx = _mm_max_pd(mx, _mm_max_pd(v0, v1));
+				s0 = _mm_add_pd(s0, v0);
+				s1 = _mm_add_pd(s1, v1);
+			}
+			double a[2], b[2], c[2];
+			_mm_storeu_pd(a, mn);
+			_mm_storeu_pd(b, mx);
+			_mm_storeu_pd(c, _mm_add_pd(s0, s1));
+			s.min = a[1] < a[0] ? a[1] : a[0];
+			s.max = b[0] < b[1] ? b[1] : b[0];
+			s.sum = c[0] + c[1];
+			s.count = i;
+		}
+	}
+#endif
+
+	// SIMD߂ňȂ^ƒ[
+	scalarStats(data, i, count, s);
+	return s;
+}
+
+template<typename T>
+inline DataStats<T> DataAggregate::stats(const DataItem& item)
+{
+	size_t count;
+	const T* data = elements<T>(item, count);
+	return stats(data, count);
+}
+
+template<typename T>
+inline DataStats<T> DataAggregate::stats(const DataBox& box, std::string_view name, DataThreadPool& pool)
+{
+	return subtree<DataStats<T>>(box, name, [](const DataItem& item, DataStats<T>& s)
+	{
+		s.merge(stats<T>(item));
+	}, pool);
+}
+
+template<typename T>
+inline size_t DataAggregate::countIf(const T* data, size_t count, DataCompare compare, T value)
+{
+	static_assert(std::is_arithmetic_v<T>, "l^̂");
+
+	size_t n = 0;
+	size_t i = 0;
+#if defined(FDA_SIMD_AVX2)
+	if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>)
+	{
+		// ͔r̎ނ̂܂ܔr߂̏qɂł
+		constexpr size_t lanes = 32 / sizeof(T);
+		auto count8 = [&](auto predicate)
+		{
+			for (; i + lanes <= count; i += lanes)
+			{
+				if constexpr (std::is_same_v<T, float>)
+					n += popcount(static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(data + i), _mm256_set1_ps(value), decltype(predicate)::value))));
+				else
+					n += popcount(static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(data + i), _mm256_set1_pd(value), decltype(predicate)::value))));
+			}
+		};
+		switch (compare)
+		{
+		case DataCompare::EQUAL: count8(std::integral_constant<int, _CMP_EQ_OQ>()); break;
+		case DataCompare::NOT_EQUAL: count8(std::integral_constant<int, _CMP_NEQ_UQ>()); break;
+		case DataCompare::LESS: count8(std::integral_constant<int, _CMP_LT_OQ>()); break;
+		case DataCompare::LESS_EQUAL: count8(std::integral_constant<int, _CMP_LE_OQ>()); break;
+		case DataCompare::GREATER: count8(std::integral_constant<int, _CMP_GT_OQ>()); break;
+		case DataCompare::GREATER_EQUAL: count8(std::integral_constant<int, _CMP_GE_OQ>()); break;
+		}
+	}
+	else if constexpr (std::is_same_v<T, int32_t>)
+	{
+		// EQUALGREATER̔r߂Ȃ̂ŁA̓ւƔےŎc
+		__m256i x = _mm256_set1_epi32(value);
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+			unsigned m = 0;
+			switch (compare)
+			{
+			case DataCompare::EQUAL:
+			case DataCompare::NOT_EQUAL: m = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, x)))); break;
+			case DataCompare::GREATER:
+			case DataCompare::LESS_EQUAL: m = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(v, x)))); break;
+			case DataCompare::LESS:
+			case DataCompare::GREATER_EQUAL: m = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(x, v)))); break;
+			}
+			if (compare == DataCompare::NOT_EQUAL || compare == DataCompare::LESS_EQUAL || compare == DataCompare::GREATER_EQUAL)
+				m = ~m & 0xFF;
+			n += popcount(m);
+		}
+	}
+#elif defined(FDA_SIMD_SSE2)
+	if constexpr (std::is_same_v<T, float>)
+	{
+		__m128 x = _mm_set1_ps(value);
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 v = _mm_loadu_ps(data + i);
+			__m128 c;
+			switch (compare)
+			{
+			case DataCompare::EQUAL: c = _mm_cmpeq_ps(v, x); break;
+			case DataCompare::NOT_EQUAL: c = _mm_cmpneq_ps(v, x); break;
+			case DataCompare::LESS: c = _mm_cmplt_ps(v, x); break;
+			case DataCompare::LESS_EQUAL: c = _mm_cmple_ps(v, x); break;
+			case DataCompare::GREATER: c = _mm_cmpgt_ps(v, x); break;
+			default: c = _mm_cmpge_ps(v, x); break;
+			}
+			n += popcount(static_cast<unsigned>(_mm_movemask_ps(c)));
+		}
+	}
+	else if constexpr (std::is_same_v<T, double>)
+	{
+		__m128d x = _mm_set1_pd(value);
+		for (; i + 2 <= count; i += 2)
+		{
+			__m128d v = _mm_loadu_pd(data + i);
+			__m128d c;
+			switch (compare)
+			{
+			case DataCompare::EQUAL: c = _mm_cmpeq_pd(v, x); break;
+			case DataCompare::NOT_EQUAL: c = _mm_cmpneq_pd(v, x); break;
+			case DataCompare::LESS: c = _mm_cmplt_pd(v, x); break;
+			case DataCompare::LESS_EQUAL: c = _mm_cmple_pd(v, x); break;
+			case DataCompare::GREATER: c = _mm_cmpgt_pd(v, x); break;
+			default: c = _mm_cmpge_pd(v, x); break;
+			}
+			n += popcount(static_cast<unsigned>(_mm_movemask_pd(c)));
+		}
+	}
+#endif
+
+	return n + scalarCount(data, i, count, compare, value);
+}
+
+template<typename T>
+inline size_t DataAggregate::countIf(const DataItem& item, DataCompare compare, T value)
+{
+	size_t count;
+	const T* data = elements<T>(item, count);
+	return countIf(data, count, compare, value);
+}
+
+template<typename T>
+inline size_t DataAggregate::countIf(const DataBox& box, std::string_view name, DataCompare compare, T value, DataThreadPool& pool)
+{
+	return subtree<size_t>(box, name, [compare, value](const DataItem& item, size_t& n)
+	{
+		n += countIf<T>(item, compare, value);
+	}, pool);
+}
+
+template<typename T, typename Predicate>
+inline size_t DataAggregate::countIf(const DataItem& item, Predicate&& predicate)
+{
+	size_t count;
+	const T* data = elements<T>(item, count);
+	size_t n = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (predicate(data[i]))
+			++n;
+	}
+	return n;
+}
+
+template<typename T>
+inline const T* DataAggregate::elements(const DataItem& item, size_t& count)
+{
+	static_assert(!std::is_pointer_v<T> && !std::is_array_v<T>, "|C^Ez͖");
+
+	if (std::alignment_of_v<T> != item.getElementSize())
+		throw std::runtime_error("DataAggregate: type mismatch");
+
+	count = item.getElementCount() == 0 ? 1 : item.getElementCount();
+	return static_cast<const T*>(item.getElementPointer());
+}
+
+template<typename T>
+inline void DataAggregate::scalarStats(const T* data, size_t first, size_t last, DataStats<T>& s)
+{
+	for (size_t i = first; i < last; ++i)
+	{
+		T v = data[i];
+		s.sum += static_cast<typename DataStats<T>::Sum>(v);
+		if (v < s.min)
+			s.min = v;
+		if (s.max < v)
+			s.max = v;
+	}
+	s.count += last > first ? last - first : 0;
+}
+
+template<typename T>
+inline size_t DataAggregate::scalarCount(const T* data, size_t first, size_t last, DataCompare compare, T value)
+{
+	size_t n = 0;
+	for (size_t i = first; i < last; ++i)
+	{
+		T v = data[i];
+		switch (compare)
+		{
+		case DataCompare::EQUAL: n += v == value; break;
+		case DataCompare::NOT_EQUAL: n += v != value; break;
+		case DataCompare::LESS: n += v < value; break;
+		case DataCompare::LESS_EQUAL: n += v <= value; break;
+		case DataCompare::GREATER: n += v > value; break;
+		case DataCompare::GREATER_EQUAL: n += v >= value; break;
+		}
+	}
+	return n;
+}
+
+template<typename Result, typename Function>
+inline Result DataAggregate::walk(const DataBox& box, std::string_view name, Function& function)
+{
+	Result r = Result();
+	if (const DataItem* item = box.findItem(name))
+		function(*item, r);
+	for (auto& i : box.boxes())
+	{
+		Result s = walk<Result>(i.second, name, function);
+		if constexpr (std::is_same_v<Result, size_t>)
+			r += s;
+		else
+			r.merge(s);
+	}
+	return r;
+}
+
+template<typename Result, typename Function>
+inline Result DataAggregate::subtree(const DataBox& box, std::string_view name, Function&& function, DataThreadPool& pool)
+{
+	// ςޑOɏWv̂ŁAŗOĂchildrenQƂ鏈͎cȂ
+	Result r = Result();
+	if (const DataItem* item = box.findItem(name))
+		function(*item, r);
+
+	// qDataBoxXbh̐{̑gɕAgƂ1̏ƂĐς
+	std::vector<const DataBox*> children;
+	children.reserve(box.boxes().size());
+	for (auto& i : box.boxes())
+		children.push_back(&i.second);
+
+	size_t groups = (std::min)(children.size(), pool.size() * 4);
+	std::vector<std::future<Result>> futures;
+	futures.reserve(groups);
+	for (size_t g = 0; g < groups; ++g)
+	{
+		size_t first = children.size() * g / groups;
+		size_t last = children.size() * (g + 1) / groups;
+		futures.push_back(pool.submit([&children, &function, name, first, last]()
+		{
+			Result r = Result();
+			for (size_t i = first; i < last; ++i)
+			{
+				Result s = walk<Result>(*children[i], name, function);
+				if constexpr (std::is_same_v<Result, size_t>)
+					r += s;
+				else
+					r.merge(s);
+			}
+			return r;
+		}));
+	}
+
+	// OĂASĂ̏I܂childrenjȂ
+	std::exception_ptr error;
+	for (auto& f : futures)
+	{
+		try
+		{
+			Result s = f.get();
+			if constexpr (std::is_same_v<Result, size_t>)
+				r += s;
+			else
+				r.merge(s);
+		}
+		catch (...)
+		{
+			if (!error)
+				error = std::current_exception();
+		}
+	}
+	if (error)
+		std::rethrow_exception(error);
+	return r;
+}
+
+inline size_t DataAggregate::popcount(unsigned mask)
+{
+	return std::bitset<32>(mask).count();
+}
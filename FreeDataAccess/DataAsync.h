@@ -0,0 +1,309 @@
+#pragma once
+
+#include "DataParser.h"
+#include "DataThreadPool.h"
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/// <summary>
+/// <para>DataBox̃t@Co͂ĂяõXbh~߂ɍs֐Q</para>
+/// <para>ǂݍ݂Ɖ́AƏ݂ꂼfЂƂɃXbhv[ŕsĐi߂</para>
+/// <para>܂őΏۂDataBoxύXEjEǂݎ肵Ȃ (outputFileDataItem̏ێ邽)</para>
+/// <para>ǂݍ݁E݁E͂葬ꍇ́A܂fЂ萔𒴂Ƃœǂݍ݁E~߂</para>
+/// </summary>
+class DataAsync
+{
+public:
+	/// <summary>
+	/// <para>t@C񓯊ɓǂݍ</para>
+	/// <para>ǂݍ݂ɐꍇbox̒gu</para>
+	/// <para>ԈĂꍇAstd::future::get()O𓊂</para>
+	/// </summary>
+	/// <param name="box">ǂݍݐ</param>
+	/// <param name="path">t@CpX</param>
+	/// <param name="pool">gpXbhv[</param>
+	/// <returns>true=, false=t@CJȂ</returns>
+	static std::future<bool> inputFile(DataBox& box, const char* path, DataThreadPool& pool = DataThreadPool::shared());
+
+	/// <summary>
+	/// <para>t@Cɔ񓯊ɏ</para>
+	/// <para>fЂłԂɎ̒fЂ</para>
+	/// </summary>
+	/// <param name="box">DataBox</param>
+	/// <param name="path">t@CpX</param>
+	/// <param name="pool">gpXbhv[</param>
+	/// <param name="style">o͂̏</param>
+	/// <returns>true=, false=t@CJȂ</returns>
+	static std::future<bool> outputFile(const DataBox& box, const char* path, DataThreadPool& pool = DataThreadPool::shared(), DataOutputStyle style = DataOutputStyle::INDENTED);
+
+	/// <summary>
+	/// <para>1̒fЂ̖ڈ̃oCg</para>
+	/// </summary>
+	static const size_t CHUNK_SIZE = 1 << 20;
+
+	/// <summary>
+	/// <para>݁E͂҂ĂfЂ̐</para>
+	/// </summary>
+	static const size_t MAX_PENDING_CHUNKS = 4;
+
+private:
+	/// <summary>
+	/// <para>fЂ󂯎1i</para>
+	/// <para>łȂΒfЂ󂯎_ŃXbhv[ɏςނ̂ŁAXbhLȂ</para>
+	/// <para>fЂMAX_PENDING_CHUNKS葽܂ƁAn͏̃Xbh҂ÃXbhΎgŏ</para>
+	/// </summary>
+	struct Stage
+	{
+		DataThreadPool* pool;
+		std::mutex mutex;
+		std::condition_variable consumed;
+		std::deque<std::string> chunks;
+		bool posted;
+		bool draining;
+		bool closed;
+		bool finished;
+		std::exception_ptr error;
+		std::function<void(std::string&)> consume;
+		std::function<void(std::exception_ptr)> done;
+	};
+
+	static std::shared_ptr<Stage> createStage(DataThreadPool& pool);
+	static void push(const std::shared_ptr<Stage>& stage, std::string&& chunk);
+	static void close(const std::shared_ptr<Stage>& stage, std::exception_ptr error);
+	static void schedule(const std::shared_ptr<Stage>& stage);
+	static void run(const std::shared_ptr<Stage>& stage);
+	static void drain(const std::shared_ptr<Stage>& stage);
+};
+
+
+
+
+inline std::future<bool> DataAsync::inputFile(DataBox& box, const char* path, DataThreadPool& pool)
+{
+	auto promise = std::make_shared<std::promise<bool>>();
+	auto future = promise->get_future();
+
+	pool.post([&box, file = std::string(path), &pool, promise]()
+	{
+		auto stream = std::make_shared<std::ifstream>(file, std::ios::in);
+		if (!*stream)
+		{
+			promise->set_value(false);
+			return;
+		}
+
+		// DataParser͉͂̒iAfinish()Ƃboxu
+		auto parser = std::make_shared<DataParser>(box);
+		auto stage = createStage(pool);
+		stage->consume = [parser](std::string& chunk)
+		{
+			parser->feed(chunk.data(), chunk.size());
+		};
+		stage->done = [promise, parser](std::exception_ptr error)
+		{
+			try
+			{
+				if (error)
+					std::rethrow_exception(error);
+				parser->finish();
+				promise->set_value(true);
+			}
+			catch (...)
+			{
+				promise->set_exception(std::current_exception());
+			}
+		};
+
+		// ǂݍ񂾒fЂ͂̒iɓnA̒fЂǂݍ
+		try
+		{
+			while (*stream)
+			{
+				std::string chunk(CHUNK_SIZE, '\0');
+				{
+					FDA_TRACE_PHASE(DataTracePhase::READ);
+					stream->read(&chunk[0], chunk.size());
+				}
+				chunk.resize(static_cast<size_t>(stream->gcount()));
+				if (!chunk.empty())
+					push(stage, std::move(chunk));
+			}
+			close(stage, nullptr);
+		}
+		catch (...)
+		{
+			close(stage, std::current_exception());
+		}
+	});
+
+	return future;
+}
+
+inline std::future<bool> DataAsync::outputFile(const DataBox& box, const char* path, DataThreadPool& pool, DataOutputStyle style)
+{
+	auto promise = std::make_shared<std::promise<bool>>();
+	auto future = promise->get_future();
+
+	pool.post([&box, file = std::string(path), &pool, style, promise]()
+	{
+		auto stream = std::make_shared<std::ofstream>(file, std::ios::out);
+		if (!*stream)
+		{
+			promise->set_value(false);
+			return;
+		}
+
+		auto stage = createStage(pool);
+		stage->consume = [stream](std::string& chunk)
+		{
+			FDA_TRACE_PHASE(DataTracePhase::WRITE);
+			stream->write(chunk.data(), chunk.size());
+		};
+		stage->done = [promise, stream](std::exception_ptr error)
+		{
+			stream->close();
+			if (error)
+				promise->set_exception(error);
+			else
+				promise->set_value(!stream->fail());
+		};
+
+		// 񂪈̑傫ɂȂ邲Ƃɏ݂̒iɓn
+		try
+		{
+			std::string text;
+			{
+				FDA_TRACE_PHASE(DataTracePhase::FORMAT);
+				box.output(text, std::string(), style, [&stage](std::string& t)
+				{
+					if (t.size() >= CHUNK_SIZE)
+					{
+						push(stage, std::move(t));
+						t = std::string();
+					}
+				});
+			}
+			if (!text.empty())
+				push(stage, std::move(text));
+			close(stage, nullptr);
+		}
+		catch (...)
+		{
+			close(stage, std::current_exception());
+		}
+	});
+
+	return future;
+}
+
+inline std::shared_ptr<DataAsync::Stage> DataAsync::createStage(DataThreadPool& pool)
+{
+	auto stage = std::make_shared<Stage>();
+	stage->pool = &pool;
+	stage->posted = false;
+	stage->draining = false;
+	stage->closed = false;
+	stage->finished = false;
+	return stage;
+}
+
+inline void DataAsync::push(const std::shared_ptr<Stage>& stage, std::string&& chunk)
+{
+	std::unique_lock<std::mutex> lock(stage->mutex);
+	stage->chunks.push_back(std::move(chunk));
+
+	// ܂肷ꍇÃXbh΂҂A΂̃Xbhŏ
+	// Xbhv[ɐς񂾏҂ƁAXbhȂꍇɐi܂ȂȂ̂ő҂Ȃ
+	while (stage->chunks.size() > MAX_PENDING_CHUNKS)
+	{
+		if (stage->draining)
+		{
+			stage->consumed.wait(lock);
+			continue;
+		}
+		stage->draining = true;
+		lock.unlock();
+		drain(stage);
+		return;
+	}
+	schedule(stage);
+}
+
+inline void DataAsync::close(const std::shared_ptr<Stage>& stage, std::exception_ptr error)
+{
+	std::lock_guard<std::mutex> lock(stage->mutex);
+	stage->closed = true;
+	if (!stage->error)
+		stage->error = error;
+	schedule(stage);
+}
+
+inline void DataAsync::schedule(const std::shared_ptr<Stage>& stage)
+{
+	// stage->mutexbNԂŌĂԂ
+	if (stage->posted || stage->draining)
+		return;
+	stage->posted = true;
+	stage->pool->post([stage]() { run(stage); });
+}
+
+inline void DataAsync::run(const std::shared_ptr<Stage>& stage)
+{
+	{
+		std::lock_guard<std::mutex> lock(stage->mutex);
+		stage->posted = false;
+		// ς񂾌ɓñXbhn߂Ă΁AɔC
+		if (stage->draining)
+			return;
+		stage->draining = true;
+	}
+	drain(stage);
+}
+
+inline void DataAsync::drain(const std::shared_ptr<Stage>& stage)
+{
+	// stage->drainingtrueɂXbhĂ
+	while (true)
+	{
+		std::string chunk;
+		bool failed;
+		{
+			std::lock_guard<std::mutex> lock(stage->mutex);
+			if (stage->chunks.empty())
+			{
+				stage->draining = false;
+				if (!stage->closed || stage->finished)
+					return;
+				stage->finished = true;
+				break;
+			}
+			chunk = std::move(stage->chunks.front());
+			stage->chunks.pop_front();
+			failed = static_cast<bool>(stage->error);
+		}
+		stage->consumed.notify_all();
+
+		// s̒fЂ͎̂Ă
+		if (failed)
+			continue;
+		try
+		{
+			stage->consume(chunk);
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(stage->mutex);
+			stage->error = std::current_exception();
+		}
+	}
+
+	// ꂽ͒fЂς܂ꂸAfinished1񂾂ɂĂ
+	stage->done(stage->error);
+}
@@ -0,0 +1,210 @@
+#pragma once
+
+#include "DataError.h"
+#include "DataSimd.h"
+#include <cstdint>
+#include <string>
+
+/// <summary>
+/// <para>DataFormat::BLOBŎgbase64 (RFC 4648, '='ɂ閄ߑ) ̕ϊ֐Q</para>
+/// <para>fR[hAVX2ꍇ32܂Ƃ߂ĕϊAȊOƒ[4ϊ</para>
+/// </summary>
+class DataBase64
+{
+public:
+	/// <returns>sizeoCgGR[h</returns>
+	static size_t encodedSize(size_t size);
+
+	/// <summary>
+	/// <para>dataGR[htext̖ɒǉ</para>
+	/// </summary>
+	static void encode(const void* data, size_t size, std::string& text);
+
+	/// <returns>
+	/// <para>lengthfR[hoCg</para>
+	/// <para>length4̔{łȂꍇ0</para>
+	/// </returns>
+	static size_t decodedSize(const char* text, size_t length);
+
+	/// <summary>
+	/// <para>lengthfR[hdataɏ</para>
+	/// <para>dataɂdecodedSize()oCg̗̈悪邱</para>
+	/// </summary>
+	/// <returns>sꍇAINVALID_VALUEtext̐擪̈ʒu</returns>
+	static DataParseResult decode(const char* text, size_t length, void* data);
+
+private:
+	static const char* alphabet();
+	static const uint8_t* table();
+};
+
+
+
+
+inline size_t DataBase64::encodedSize(size_t size)
+{
+	return (size + 2) / 3 * 4;
+}
+
+inline void DataBase64::encode(const void* data, size_t size, std::string& text)
+{
+	const uint8_t* p = static_cast<const uint8_t*>(data);
+	const char* a = alphabet();
+
+	size_t n = text.size();
+	text.resize(n + encodedSize(size));
+	char* o = &text[n];
+
+	size_t i = 0;
+	for (; i + 3 <= size; i += 3)
+	{
+		uint32_t v = (static_cast<uint32_t>(p[i]) << 16) | (static_cast<uint32_t>(p[i + 1]) << 8) | p[i + 2];
+		o[0] = a[v >> 18];
+		o[1] = a[(v >> 12) & 0x3F];
+		o[2] = a[(v >> 6) & 0x3F];
+		o[3] = a[v & 0x3F];
+		o += 4;
+	}
+	if (i < size)
+	{
+		uint32_t v = static_cast<uint32_t>(p[i]) << 16;
+		if (i + 1 < size)
+			v |= static_cast<uint32_t>(p[i + 1]) << 8;
+		o[0] = a[v >> 18];
+		o[1] = a[(v >> 12) & 0x3F];
+		o[2] = i + 1 < size ? a[(v >> 6) & 0x3F] : '=';
+		o[3] = '=';
+	}
+}
+
+inline size_t DataBase64::decodedSize(const char* text, size_t length)
+{
+	if (length % 4 != 0)
+		return 0;
+
+	size_t size = length / 4 * 3;
+	if (length > 0 && text[length - 1] == '=')
+		--size;
+	if (length > 1 && text[length - 2] == '=')
+		--size;
+	return size;
+}
+
+inline DataParseResult DataBase64::decode(const char* text, size_t length, void* data)
+{
+	if (length % 4 != 0)
+		return DataParseResult(DataError::INVALID_VALUE, length);
+
+	const uint8_t* in = reinterpret_cast<const uint8_t*>(text);
+	uint8_t* out = static_cast<uint8_t*>(data);
+	const uint8_t* t = table();
+
+	// ߑ܂ލŌ41mF
+	size_t body = length;
+	if (length > 0 && text[length - 1] == '=')
+		body -= 4;
+
+	size_t i = 0;
+#if defined(FDA_SIMD_AVX2)
+	// 3224oCgɂB32oCgނ̂ŁA8oCgȏcԂg
+	{
+		const __m256i lutLo = _mm256_setr_epi8(
+			0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+			0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+		const __m256i lutHi = _mm256_setr_epi8(
+			0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+			0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+		const __m256i lutRoll = _mm256_setr_epi8(
+			0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+		const __m256i mask2F = _mm256_set1_epi8(0x2F);
+		const __m256i pack = _mm256_setr_epi8(
+			2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+			2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+		const __m256i permute = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, -1, -1);
+
+		for (; i + 44 <= body; i += 32)
+		{
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+
+			// 4rbgƉ4rbg̕\̗ɓĂ͂܂镶Εs
+			__m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(v, 4), mask2F);
+			__m256i loNibbles = _mm256_and_si256(v, mask2F);
+			__m256i lo = _mm256_shuffle_epi8(lutLo, loNibbles);
+			__m256i hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+			if (!_mm256_testz_si256(lo, hi))
+				break;
+
+			// 6rbg̒lɂ
+			__m256i eq2F = _mm256_cmpeq_epi8(v, mask2F);
+			v = _mm256_add_epi8(v, _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(eq2F, hiNibbles)));
+
+			// 46rbg3oCgɋl߂
+			v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+			v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+			v = _mm256_shuffle_epi8(v, pack);
+			v = _mm256_permutevar8x32_epi32(v, permute);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), v);
+			out += 24;
+		}
+	}
+#endif
+
+	// sȕꍇňʒu肷
+	for (; i + 4 <= body; i += 4)
+	{
+		uint32_t a = t[in[i]], b = t[in[i + 1]], c = t[in[i + 2]], d = t[in[i + 3]];
+		if ((a | b | c | d) & 0x80)
+		{
+			size_t j = i;
+			while ((t[in[j]] & 0x80) == 0)
+				++j;
+			return DataParseResult(DataError::INVALID_VALUE, j);
+		}
+		uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+		out[0] = static_cast<uint8_t>(v >> 16);
+		out[1] = static_cast<uint8_t>(v >> 8);
+		out[2] = static_cast<uint8_t>(v);
+		out += 3;
+	}
+
+	if (body < length)
+	{
+		// xx==  xxx= ̂ǂ炩
+		uint32_t a = t[in[i]], b = t[in[i + 1]];
+		bool two = in[i + 2] == '=';
+		uint32_t c = two ? 0 : t[in[i + 2]];
+		if ((a | b | c) & 0x80)
+			return DataParseResult(DataError::INVALID_VALUE, i + (a & 0x80 ? 0 : b & 0x80 ? 1 : 2));
+		uint32_t v = (a << 18) | (b << 12) | (c << 6);
+		out[0] = static_cast<uint8_t>(v >> 16);
+		if (!two)
+			out[1] = static_cast<uint8_t>(v >> 8);
+	}
+
+	return DataParseResult();
+}
+
+inline const char* DataBase64::alphabet()
+{
+	return "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+}
+
+inline const uint8_t* DataBase64::table()
+{
+	// 6rbg̒l\ (0xFF=base64̕ł͂Ȃ)
+	struct Table
+	{
+		uint8_t value[256];
+		Table()
+		{
+			for (int i = 0; i < 256; ++i)
+				value[i] = 0xFF;
+			const char* a = alphabet();
+			for (int i = 0; i < 64; ++i)
+				value[static_cast<uint8_t>(a[i])] = static_cast<uint8_t>(i);
+		}
+	};
+	static const Table table;
+	return table.value;
+}
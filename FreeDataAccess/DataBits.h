@@ -0,0 +1,487 @@
+#pragma once
+
+#include "DataSimd.h"
+#include <cstdint>
+#include <stdexcept>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/// <summary>
+/// <para>DataBits1rbgQƂNX</para>
+/// <para>boolւ̎QƂƓ悤ɓǂݏł</para>
+/// </summary>
+class DataBitReference
+{
+public:
+	DataBitReference(uint64_t* word, uint64_t mask);
+
+	operator bool() const;
+	DataBitReference& operator=(bool value);
+	DataBitReference& operator=(const DataBitReference& rhs);
+
+	/// <summary>
+	/// <para>rbg𔽓]</para>
+	/// </summary>
+	void flip();
+
+private:
+	uint64_t* m_word;
+	uint64_t m_mask;
+};
+
+/// <summary>
+/// <para>boolz1vf1rbgɋl߂zǂރNX (l͏LȂ)</para>
+/// <para>iԖڂ̗vf (i / 64)Ԗڂ̃[h̉ (i % 64)rbgڂɓĂ</para>
+/// <para>Ō̃[h̗]rbg͏0ɂĂ</para>
+/// <para>グEAVX2ꍇ4[hAȊO1[h</para>
+/// </summary>
+class DataConstBits
+{
+public:
+	/// <param name="words">[hz̐擪̃|C^</param>
+	/// <param name="size">vf (rbg)</param>
+	DataConstBits(const uint64_t* words, size_t size);
+
+public:
+	/// <summary>
+	/// <para>findFirst()ŌȂƂ\</para>
+	/// </summary>
+	static const size_t npos = static_cast<size_t>(-1);
+
+	/// <returns>vf (rbg)</returns>
+	size_t size() const;
+
+	/// <returns>[h</returns>
+	size_t wordCount() const;
+
+	/// <returns>[hz̐擪̃|C^</returns>
+	const uint64_t* words() const;
+
+	/// <returns>iԖڂ̗vf̒l</returns>
+	bool operator[](size_t i) const;
+
+	/// <returns>true̗vf</returns>
+	size_t count() const;
+
+	/// <returns>fromԖڈȍ~ōŏtrueɂȂĂvf̈ʒu, npos=Ȃ</returns>
+	size_t findFirst(size_t from = 0) const;
+
+	/// <returns>vfƂׂĂ̗vftrue</returns>
+	bool equals(const DataConstBits& rhs) const;
+
+	/// <returns>sizevfl߂̂ɕKvȃ[h</returns>
+	static size_t wordCount(size_t size);
+
+	/// <summary>
+	/// <para>boolz[hzɋl߂</para>
+	/// <para>wordsɂwordCount(size)[ḧ̗悪邱</para>
+	/// </summary>
+	static void pack(const bool* values, size_t size, uint64_t* words);
+
+	/// <summary>
+	/// <para>[hzboolzɍL</para>
+	/// </summary>
+	static void unpack(const uint64_t* words, size_t size, bool* values);
+
+protected:
+	static size_t popcount(uint64_t v);
+	static size_t countTrailingZeros(uint64_t v);
+
+	/// <returns>Ō̃[h̎gĂrbg̃}XN</returns>
+	uint64_t lastMask() const;
+
+protected:
+	const uint64_t* m_words;
+	size_t m_size;
+};
+
+/// <summary>
+/// <para>boolz1vf1rbgɋl߂zǂݏNX (l͏LȂ)</para>
+/// <para>rbgZAVX2 (SSE2) ̖߂ŕ[h</para>
+/// </summary>
+class DataBits : public DataConstBits
+{
+public:
+	/// <param name="words">[hz̐擪̃|C^</param>
+	/// <param name="size">vf (rbg)</param>
+	DataBits(uint64_t* words, size_t size);
+
+public:
+	using DataConstBits::operator[];
+
+	/// <returns>iԖڂ̗vfւ̎Q</returns>
+	DataBitReference operator[](size_t i);
+
+	/// <returns>[hz̐擪̃|C^</returns>
+	uint64_t* words();
+
+	/// <summary>
+	/// <para>iԖڂ̗vfݒ肷</para>
+	/// </summary>
+	void set(size_t i, bool value = true);
+
+	/// <summary>
+	/// <para>SĂ̗vfݒ肷</para>
+	/// </summary>
+	void fill(bool value);
+
+	/// <summary>
+	/// <para>SĂ̗vf𔽓]</para>
+	/// </summary>
+	void flip();
+
+	/// <summary>
+	/// <para>vfƂ̘_ρE_aErI_agɑ</para>
+	/// <para>vfقȂƗO</para>
+	/// </summary>
+	DataBits& operator&=(const DataConstBits& rhs);
+	DataBits& operator|=(const DataConstBits& rhs);
+	DataBits& operator^=(const DataConstBits& rhs);
+
+private:
+	enum class Operation
+	{
+		AND,
+		OR,
+		XOR
+	};
+
+	void apply(const DataConstBits& rhs, Operation op);
+};
+
+
+
+
+inline DataBitReference::DataBitReference(uint64_t* word, uint64_t mask)
+	: m_word(word)
+	, m_mask(mask)
+{
+}
+
+inline DataBitReference::operator bool() const
+{
+	return (*m_word & m_mask) != 0;
+}
+
+inline DataBitReference& DataBitReference::operator=(bool value)
+{
+	if (value)
+		*m_word |= m_mask;
+	else
+		*m_word &= ~m_mask;
+	return *this;
+}
+
+inline DataBitReference& DataBitReference::operator=(const DataBitReference& rhs)
+{
+	return *this = static_cast<bool>(rhs);
+}
+
+inline void DataBitReference::flip()
+{
+	*m_word ^= m_mask;
+}
+
+inline DataConstBits::DataConstBits(const uint64_t* words, size_t size)
+	: m_words(words)
+	, m_size(size)
+{
+}
+
+inline size_t DataConstBits::size() const
+{
+	return m_size;
+}
+
+inline size_t DataConstBits::wordCount() const
+{
+	return wordCount(m_size);
+}
+
+inline const uint64_t* DataConstBits::words() const
+{
+	return m_words;
+}
+
+inline bool DataConstBits::operator[](size_t i) const
+{
+	return (m_words[i >> 6] >> (i & 63)) & 1;
+}
+
+inline size_t DataConstBits::count() const
+{
+	size_t n = wordCount();
+	size_t c = 0;
+	size_t i = 0;
+#if defined(FDA_SIMD_AVX2)
+	// 4rbg\ĐA8oCgƂɑ킹
+	if (n >= 4)
+	{
+		const __m256i table = _mm256_setr_epi8(
+			0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+			0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+		const __m256i low = _mm256_set1_epi8(0x0F);
+		__m256i total = _mm256_setzero_si256();
+		for (; i + 4 <= n; i += 4)
+		{
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m_words + i));
+			__m256i lo = _mm256_shuffle_epi8(table, _mm256_and_si256(v, low));
+			__m256i hi = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), low));
+			total = _mm256_add_epi64(total, _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256()));
+		}
+		alignas(32) uint64_t t[4];
+		_mm256_store_si256(reinterpret_cast<__m256i*>(t), total);
+		c = static_cast<size_t>(t[0] + t[1] + t[2] + t[3]);
+	}
+#endif
+	for (; i < n; ++i)
+		c += popcount(m_words[i]);
+	return c;
+}
+
+inline size_t DataConstBits::findFirst(size_t from) const
+{
+	if (from >= m_size)
+		return npos;
+
+	size_t n = wordCount();
+	size_t i = from >> 6;
+
+	// ŏ̃[hfromÕrbg
+	uint64_t w = m_words[i] & (~0ull << (from & 63));
+	if (w != 0)
+		return (i << 6) + countTrailingZeros(w);
+	++i;
+
+#if defined(FDA_SIMD_AVX2)
+	// 4[hƂ0Ȃǂݔ΂
+	for (; i + 4 <= n; i += 4)
+	{
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m_words + i));
+		if (!_mm256_testz_si256(v, v))
+			break;
+	}
+#endif
+	for (; i < n; ++i)
+	{
+		if (m_words[i] != 0)
+			return (i << 6) + countTrailingZeros(m_words[i]);
+	}
+	return npos;
+}
+
+inline bool DataConstBits::equals(const DataConstBits& rhs) const
+{
+	if (m_size != rhs.m_size)
+		return false;
+	size_t n = wordCount();
+	for (size_t i = 0; i < n; ++i)
+	{
+		if (m_words[i] != rhs.m_words[i])
+			return false;
+	}
+	return true;
+}
+
+inline size_t DataConstBits::wordCount(size_t size)
+{
+	return (size + 63) >> 6;
+}
+
+inline void DataConstBits::pack(const bool* values, size_t size, uint64_t* words)
+{
+	size_t n = wordCount(size);
+	for (size_t i = 0; i < n; ++i)
+		words[i] = 0;
+
+	size_t i = 0;
+#if defined(FDA_SIMD_AVX2)
+	// 32vf0łȂoCg̍ŏʃrbgW߂
+	for (; i + 32 <= size; i += 32)
+	{
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+		uint32_t m = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_setzero_si256())));
+		words[i >> 6] |= static_cast<uint64_t>(m) << (i & 63);
+	}
+#elif defined(FDA_SIMD_SSE2)
+	for (; i + 16 <= size; i += 16)
+	{
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+		uint32_t m = ~static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128()))) & 0xFFFF;
+		words[i >> 6] |= static_cast<uint64_t>(m) << (i & 63);
+	}
+#endif
+	for (; i < size; ++i)
+	{
+		if (values[i])
+			words[i >> 6] |= 1ull << (i & 63);
+	}
+}
+
+inline void DataConstBits::unpack(const uint64_t* words, size_t size, bool* values)
+{
+	size_t i = 0;
+#if defined(FDA_SIMD_AVX2)
+	// 32rbgSẴoCgɔzAeoCg̒Srbgo
+	{
+		const __m256i spread = _mm256_setr_epi8(
+			0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+			2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+		const __m256i select = _mm256_set1_epi64x(static_cast<int64_t>(0x8040201008040201ull));
+		const __m256i one = _mm256_set1_epi8(1);
+		for (; i + 32 <= size; i += 32)
+		{
+			uint32_t m = static_cast<uint32_t>(words[i >> 6] >> (i & 63));
+			__m256i v = _mm256_shuffle_epi8(_mm256_set1_epi32(static_cast<int32_t>(m)), spread);
+			v = _mm256_cmpeq_epi8(_mm256_and_si256(v, select), select);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(values + i), _mm256_and_si256(v, one));
+		}
+	}
+#endif
+	for (; i < size; ++i)
+		values[i] = (words[i >> 6] >> (i & 63)) & 1;
+}
+
+inline size_t DataConstBits::popcount(uint64_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return static_cast<size_t>(__builtin_popcountll(v));
+#else
+	// POPCNT߂̖CPUł悤ɃrbgZŐ
+	v = v - ((v >> 1) & 0x5555555555555555ull);
+	v = (v & 0x3333333333333333ull) + ((v >> 2) & 0x3333333333333333ull);
+	v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+	return static_cast<size_t>((v * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+inline size_t DataConstBits::countTrailingZeros(uint64_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return static_cast<size_t>(__builtin_ctzll(v));
+#elif defined(_M_X64)
+	unsigned long i;
+	_BitScanForward64(&i, v);
+	return i;
+#else
+	size_t i = 0;
+	while ((v & 1) == 0)
+	{
+		v >>= 1;
+		++i;
+	}
+	return i;
+#endif
+}
+
+inline uint64_t DataConstBits::lastMask() const
+{
+	return (m_size & 63) == 0 ? ~0ull : (1ull << (m_size & 63)) - 1;
+}
+
+inline DataBits::DataBits(uint64_t* words, size_t size)
+	: DataConstBits(words, size)
+{
+}
+
+inline DataBitReference DataBits::operator[](size_t i)
+{
+	return DataBitReference(words() + (i >> 6), 1ull << (i & 63));
+}
+
+inline uint64_t* DataBits::words()
+{
+	// ߂zŐĂ̂ŊOĂ悢
+	return const_cast<uint64_t*>(m_words);
+}
+
+inline void DataBits::set(size_t i, bool value)
+{
+	(*this)[i] = value;
+}
+
+inline void DataBits::fill(bool value)
+{
+	size_t n = wordCount();
+	uint64_t* w = words();
+	for (size_t i = 0; i < n; ++i)
+		w[i] = value ? ~0ull : 0;
+	if (n > 0)
+		w[n - 1] &= lastMask();
+}
+
+inline void DataBits::flip()
+{
+	size_t n = wordCount();
+	uint64_t* w = words();
+	for (size_t i = 0; i < n; ++i)
+		w[i] = ~w[i];
+	if (n > 0)
+		w[n - 1] &= lastMask();
+}
+
+inline DataBits& DataBits::operator&=(const DataConstBits& rhs)
+{
+	apply(rhs, Operation::AND);
+	return *this;
+}
+
+inline DataBits& DataBits::operator|=(const DataConstBits& rhs)
+{
+	apply(rhs, Operation::OR);
+	return *this;
+}
+
+inline DataBits& DataBits::operator^=(const DataConstBits& rhs)
+{
+	apply(rhs, Operation::XOR);
+	return *this;
+}
+
+inline void DataBits::apply(const DataConstBits& rhs, Operation op)
+{
+	if (m_size != rhs.size())
+		throw std::invalid_argument("DataBits: size mismatch");
+
+	size_t n = wordCount();
+	uint64_t* w = words();
+	const uint64_t* r = rhs.words();
+	size_t i = 0;
+#if defined(FDA_SIMD_AVX2)
+	for (; i + 4 <= n; i += 4)
+	{
+		__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + i));
+		__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(r + i));
+		switch (op)
+		{
+		case Operation::AND: a = _mm256_and_si256(a, b); break;
+		case Operation::OR: a = _mm256_or_si256(a, b); break;
+		case Operation::XOR: a = _mm256_xor_si256(a, b); break;
+		}
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(w + i), a);
+	}
+#elif defined(FDA_SIMD_SSE2)
+	for (; i + 2 <= n; i += 2)
+	{
+		__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w + i));
+		__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r + i));
+		switch (op)
+		{
+		case Operation::AND: a = _mm_and_si128(a, b); break;
+		case Operation::OR: a = _mm_or_si128(a, b); break;
+		case Operation::XOR: a = _mm_xor_si128(a, b); break;
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(w + i), a);
+	}
+#endif
+	for (; i < n; ++i)
+	{
+		switch (op)
+		{
+		case Operation::AND: w[i] &= r[i]; break;
+		case Operation::OR: w[i] |= r[i]; break;
+		case Operation::XOR: w[i] ^= r[i]; break;
+		}
+	}
+}
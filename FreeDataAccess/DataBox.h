@@ -2,19 +2,61 @@
 
 #include "DataItem.h"
 #include <string>
+#include <string_view>
 #include <map>
+#include <optional>
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <stdexcept>
 #include <fstream>
 #include <sstream>
 #include <mbstring.h>
 
+/// <summary>
+/// <para>DataBox::visit()ɓn֐Ԃl</para>
+/// <para>CONTINUE=</para>
+/// <para>SKIP=DataBox̒gHȂ (DataItem̏ꍇCONTINUEƓ)</para>
+/// <para>STOP=I</para>
+/// </summary>
+enum class DataVisit
+{
+	CONTINUE,
+	SKIP,
+	STOP
+};
+
 /// <summary>
 /// <para>DataItemNXKw\ŏNX</para>
 /// <para>DataBoxDataBoxDataItem</para>
 /// <para>t@Co͂gpꍇpath֑̋</para>
 /// <para>[ ] ( ){ } / ' " $</para>
 /// </summary>
-class DataBox
+class DataBox : public DataHashNode
 {
+public:
+	using BoxMap = std::map<std::string, DataBox, std::less<>>;
+	using ItemMap = std::map<std::string, DataItem, std::less<>>;
+
+	/// <summary>
+	/// <para>q͈̔͂\</para>
+	/// <para>͈forŖO(O, q)̃yAo</para>
+	/// </summary>
+	template<typename Iterator>
+	class Range
+	{
+	public:
+		Range(Iterator first, Iterator last) : m_first(first), m_last(last) {}
+		Iterator begin() const { return m_first; }
+		Iterator end() const { return m_last; }
+		bool empty() const { return m_first == m_last; }
+		size_t size() const { return static_cast<size_t>(std::distance(m_first, m_last)); }
+
+	private:
+		Iterator m_first;
+		Iterator m_last;
+	};
+
 public:
 	DataBox();
 	~DataBox();
@@ -22,80 +64,271 @@ public:
 	DataBox(const DataBox&) = delete;
 	DataBox& operator=(const DataBox&) = delete;
 
-	DataBox(DataBox&&) noexcept = default;
-	DataBox& operator=(DataBox&&) noexcept = default;
+	DataBox(DataBox&& rhs) noexcept;
+	DataBox& operator=(DataBox&& rhs) noexcept;
 
 public:
 	/// <summary>
 	/// <para>DataBoxɃANZX</para>
 	/// <para>pX݂ȂꍇO</para>
 	/// </summary>
-	const DataBox& operator[](const char* path) const;
+	const DataBox& operator[](std::string_view path) const;
 
 	/// <summary>
 	/// <para>DataBoxɃANZX</para>
 	/// <para>pX݂ȂꍇO</para>
 	/// </summary>
-	DataBox& operator[](const char* path);
+	DataBox& operator[](std::string_view path);
 
 	/// <summary>
 	/// <para>DataItemɃANZX</para>
 	/// <para>pX݂ȂꍇO</para>
 	/// </summary>
-	const DataItem& operator()(const char* path) const;
+	const DataItem& operator()(std::string_view path) const;
 
 	/// <summary>
 	/// <para>DataItemɃANZX</para>
 	/// <para>pX݂ȂꍇO</para>
 	/// </summary>
-	DataItem& operator()(const char* path);
+	DataItem& operator()(std::string_view path);
+
+	/// <summary>
+	/// <para>DataBox</para>
+	/// <para>pX݂ȂꍇO𓊂A݂ꍇƓ1̒Tōς</para>
+	/// </summary>
+	/// <returns>DataBoxւ̃|C^, nullptr=pX݂Ȃ</returns>
+	const DataBox* findBox(std::string_view path) const;
+	DataBox* findBox(std::string_view path);
+
+	/// <summary>
+	/// <para>DataItem</para>
+	/// <para>pX݂ȂꍇO𓊂A݂ꍇƓ1̒Tōς</para>
+	/// </summary>
+	/// <returns>DataItemւ̃|C^, nullptr=pX݂Ȃ</returns>
+	const DataItem* findItem(std::string_view path) const;
+	DataItem* findItem(std::string_view path);
+
+	/// <summary>
+	/// <para>DataItem̒lo</para>
+	/// <para>pX݂ȂꍇƁAݒ肵^ƈقȂTCY̌^̏ꍇstd::nullopt</para>
+	/// </summary>
+	template<typename T>
+	std::optional<T> tryGet(std::string_view path) const;
 
 	/// <returns>true=DataBox̃pX݂</returns>
-	bool box(const char* path) const;
+	bool box(std::string_view path) const;
 
 	/// <returns>true=DataItem̃pX݂</returns>
-	bool item(const char* path) const;
+	bool item(std::string_view path) const;
 
 	/// <summary>
 	/// <para>DataBoxǉ</para>
 	/// <para>pX݂ꍇ㏑</para>
+	/// <para>std::string&amp;&amp;̃pX͐Vǉꍇɂ̂܂܃[uĎg</para>
 	/// </summary>
 	void add(const char* path, DataBox&& box);
+	void add(std::string_view path, DataBox&& box);
+	void add(std::string&& path, DataBox&& box);
 
 	/// <summary>
 	/// <para>DataItemǉ</para>
 	/// <para>pX݂ꍇ㏑</para>
+	/// <para>std::string&amp;&amp;̃pX͐Vǉꍇɂ̂܂܃[uĎg</para>
 	/// </summary>
 	void add(const char* path, DataItem&& item);
+	void add(std::string_view path, DataItem&& item);
+	void add(std::string&& path, DataItem&& item);
+
+	/// <summary>
+	/// <para>pX݂ȂꍇDataBoxǉ</para>
+	/// <para>ǉȂꍇbox͕ύXȂ</para>
+	/// </summary>
+	/// <returns>true=ǉ, false=pX݂</returns>
+	bool tryAdd(const char* path, DataBox&& box);
+	bool tryAdd(std::string_view path, DataBox&& box);
+	bool tryAdd(std::string&& path, DataBox&& box);
+
+	/// <summary>
+	/// <para>pX݂ȂꍇDataItemǉ</para>
+	/// <para>ǉȂꍇitem͕ύXȂ</para>
+	/// </summary>
+	/// <returns>true=ǉ, false=pX݂</returns>
+	bool tryAdd(const char* path, DataItem&& item);
+	bool tryAdd(std::string_view path, DataItem&& item);
+	bool tryAdd(std::string&& path, DataItem&& item);
+
+	/// <summary>
+	/// <para>DataBox܂Ƃ߂Ēǉ</para>
+	/// <para>pX݂ꍇ㏑</para>
+	/// <para>OɕłĊ̎qɗꍇATɖ֒ǉ̂Ő`Ԃōς</para>
+	/// <para>łȂꍇ1add()̂ƓʂɂȂ</para>
+	/// </summary>
+	void add(std::vector<std::pair<std::string, DataBox>>&& boxes);
+
+	/// <summary>
+	/// <para>DataItem܂Ƃ߂Ēǉ</para>
+	/// <para>pX݂ꍇ㏑</para>
+	/// <para>OɕłĊ̎qɗꍇATɖ֒ǉ̂Ő`Ԃōς</para>
+	/// <para>łȂꍇ1add()̂ƓʂɂȂ</para>
+	/// </summary>
+	void add(std::vector<std::pair<std::string, DataItem>>&& items);
+
+	/// <returns>SĂ̎qDataBox͈̔</returns>
+	Range<BoxMap::const_iterator> boxes() const;
+	Range<BoxMap::iterator> boxes();
+
+	/// <returns>SĂ̎qDataItem͈̔</returns>
+	Range<ItemMap::const_iterator> items() const;
+	Range<ItemMap::iterator> items();
+
+	/// <returns>Ofirstȏlast̎qDataBox͈̔ (lastfirstȉȂ)</returns>
+	Range<BoxMap::const_iterator> boxes(std::string_view first, std::string_view last) const;
+	Range<BoxMap::iterator> boxes(std::string_view first, std::string_view last);
+
+	/// <returns>Ofirstȏlast̎qDataItem͈̔ (lastfirstȉȂ)</returns>
+	Range<ItemMap::const_iterator> items(std::string_view first, std::string_view last) const;
+	Range<ItemMap::iterator> items(std::string_view first, std::string_view last);
+
+	/// <returns>OprefixŎn܂qDataBox͈̔</returns>
+	Range<BoxMap::const_iterator> boxesWithPrefix(std::string_view prefix) const;
+	Range<BoxMap::iterator> boxesWithPrefix(std::string_view prefix);
+
+	/// <returns>OprefixŎn܂qDataItem͈̔</returns>
+	Range<ItemMap::const_iterator> itemsWithPrefix(std::string_view prefix) const;
+	Range<ItemMap::iterator> itemsWithPrefix(std::string_view prefix);
+
+	/// <summary>
+	/// <para>qċAIɒH</para>
+	/// <para>eDataBox̒DataItem𖼑OɁADataBox𖼑OɒH</para>
+	/// <para>visitor visitor(const std::string&amp; name, const DataBox&amp; box) </para>
+	/// <para>visitor(const std::string&amp; name, const DataItem&amp; item) ŌĂ΂ADataVisitԂ</para>
+	/// </summary>
+	/// <returns>true=Ō܂ŒH, false=STOPŏI</returns>
+	template<typename Visitor>
+	bool visit(Visitor&& visitor) const;
+
+	/// <summary>
+	/// <para>DataBox폜</para>
+	/// </summary>
+	/// <returns>true=폜, false=pX݂Ȃ</returns>
+	bool removeBox(std::string_view path);
+
+	/// <summary>
+	/// <para>DataItem폜</para>
+	/// </summary>
+	/// <returns>true=폜, false=pX݂Ȃ</returns>
+	bool removeItem(std::string_view path);
+
+	/// <summary>
+	/// <para>q̖OƒlvZnbVl</para>
+	/// <para>LbVĂAύXꂽvfƂ̑c悾ČvZ</para>
+	/// </summary>
+	uint64_t hash() const;
+
+	/// <summary>
+	/// <para>gǂr</para>
+	/// <para>nbVlႦΓȂƂAꍇ͏Փ˂łȂƂ𒆐grĊm߂</para>
+	/// </summary>
+	/// <returns>true=</returns>
+	bool equals(const DataBox& rhs) const;
 
 	/// <summary>
 	/// <para>DataBox̏Ԓlt@C͂</para>
 	/// <para>ꍇȀԒl͑Sď</para>
-	/// <para>t@C̏ԈĂƗO</para>
+	/// <para>t@C̏ԈĂƗO (Ԓl͕ύXȂ)</para>
+	/// <para>^O[/DataBoxName][/]̂ǂł悢</para>
 	/// </summary>
 	/// <param name="path">̓t@CpX</param>
 	/// <returns>true=, false=s</returns>
 	bool inputFile(const char* path);
 
+	/// <summary>
+	/// <para>DataBox̏Ԓl𕶎񂩂͂</para>
+	/// <para>ꍇȀԒl͑Sď</para>
+	/// <para>ԈĂĂO𓊂AG[̎ނƈʒuԂ (Ԓl͕ύXȂ)</para>
+	/// </summary>
+	/// <param name="formatText">t@CƓ̕</param>
+	DataParseResult parse(std::string_view formatText);
+
 	/// <summary>
 	/// <para>DataBox̏Ԓlt@C֏o͂</para>
 	/// </summary>
 	/// <param name="path">o̓t@CpX</param>
+	/// <param name="style">o͂̏</param>
 	/// <returns>true=, false=s</returns>
-	bool outputFile(const char* path) const;
+	bool outputFile(const char* path, DataOutputStyle style = DataOutputStyle::INDENTED) const;
 
 	/// <summary>
 	/// <para>gSč폜</para>
 	/// </summary>
 	void clear();
 
+	/// <summary>
+	/// <para>q̑SĂDataItemDataItem::intern()DataInternPoolɓo^</para>
+	/// <para>lDataItemlƏL̂ŁAlقǃgpʂ</para>
+	/// </summary>
+	/// <param name="pool">o^̃v[</param>
+	void intern(DataInternPool& pool);
+
 private:
-	void input(const std::string& formatText);
-	std::string output(const std::string& indent = std::string()) const;
+	DataParseResult input(std::string_view formatText, size_t offset);
+	std::string output(DataOutputStyle style = DataOutputStyle::INDENTED) const;
+
+	/// <summary>
+	/// <para>text̖ɏǉĂ</para>
+	/// <para>1sǉ邲Ƃflush(text)ĂԂ̂ŁAflushtextoċɂĂ悢</para>
+	/// </summary>
+	template<typename Flush>
+	void output(std::string& text, const std::string& indent, DataOutputStyle style, Flush&& flush) const;
+
+	/// <summary>
+	/// <para>qDataBox̊J^Oǉ邲Ƃchild(qDataBox, text, q̎)Ă</para>
+	/// <para>childtrueԂꍇA̎q̒g͏ɕ^Oǉ</para>
+	/// </summary>
+	template<typename Flush, typename Child>
+	void output(std::string& text, const std::string& indent, DataOutputStyle style, Flush&& flush, Child&& child) const;
+
+	void adopt(DataBox& box);
+	void adopt(DataItem& item);
+	void adoptChildren();
+
+	template<typename Map>
+	static typename Map::mapped_type& at(Map& map, std::string_view path);
+
+	template<typename Map>
+	static const typename Map::mapped_type& at(const Map& map, std::string_view path);
+
+	template<typename Map, typename Key, typename Value>
+	static Value& assign(Map& map, Key&& path, Value&& value);
+
+	/// <summary>
+	/// <para>pathꍇǉ</para>
+	/// <para>ǉƌ܂ĂbeforeChange()ĂԂ̂ŁAǉȂꍇ͕ύX̒ʒmȂ</para>
+	/// </summary>
+	template<typename Map, typename Key, typename Value>
+	Value* tryAssign(Map& map, Key&& path, Value&& value);
+
+	template<typename Map>
+	static Range<typename Map::iterator> nameRange(Map& map, std::string_view first, std::string_view last);
+
+	template<typename Map>
+	static Range<typename Map::const_iterator> nameRange(const Map& map, std::string_view first, std::string_view last);
+
+	template<typename Map>
+	static Range<typename Map::iterator> prefixRange(Map& map, std::string_view prefix);
+
+	template<typename Map>
+	static Range<typename Map::const_iterator> prefixRange(const Map& map, std::string_view prefix);
 
 private:
-	std::map<std::string, DataBox, std::less<>> m_box;
-	std::map<std::string, DataItem, std::less<>> m_item;
+	template<typename T>
+	friend class DataSchema;
+	friend class DataAsync;
+	friend class DataSnapshot;
+	friend class DataSplitFile;
+
+	BoxMap m_box;
+	ItemMap m_item;
 };
 
 
@@ -111,44 +344,337 @@ inline DataBox::~DataBox()
 {
 }
 
-inline const DataBox& DataBox::operator[](const char* path) const
+inline DataBox::DataBox(DataBox&& rhs) noexcept
+	: DataHashNode(rhs, DataChange::SUBTREE)
+	, m_box(std::move(rhs.m_box))
+	, m_item(std::move(rhs.m_item))
 {
-	return m_box.at(path);
+	adoptChildren();
+	rhs.invalidateHash();
 }
 
-inline DataBox& DataBox::operator[](const char* path)
+inline DataBox& DataBox::operator=(DataBox&& rhs) noexcept
 {
-	return m_box.at(path);
+	beforeChange(DataChange::SUBTREE);
+	rhs.beforeChange(DataChange::SUBTREE);
+	DataHashNode::operator=(rhs);
+	m_box = std::move(rhs.m_box);
+	m_item = std::move(rhs.m_item);
+	adoptChildren();
+	rhs.invalidateHash();
+	return *this;
 }
 
-inline const DataItem& DataBox::operator()(const char* path) const
+inline const DataBox& DataBox::operator[](std::string_view path) const
 {
-	return m_item.at(path);
+	FDA_TRACE_COUNT(DataTraceCounter::BOX_ACCESS);
+	return at(m_box, path);
 }
 
-inline DataItem& DataBox::operator()(const char* path)
+inline DataBox& DataBox::operator[](std::string_view path)
 {
-	return m_item.at(path);
+	FDA_TRACE_COUNT(DataTraceCounter::BOX_ACCESS);
+	return at(m_box, path);
 }
 
-inline bool DataBox::box(const char* path) const
+inline const DataItem& DataBox::operator()(std::string_view path) const
 {
-	return m_box.count(path) == 1;
+	FDA_TRACE_COUNT(DataTraceCounter::ITEM_ACCESS);
+	return at(m_item, path);
 }
 
-inline bool DataBox::item(const char* path) const
+inline DataItem& DataBox::operator()(std::string_view path)
 {
-	return m_item.count(path) == 1;
+	FDA_TRACE_COUNT(DataTraceCounter::ITEM_ACCESS);
+	return at(m_item, path);
+}
+
+inline const DataBox* DataBox::findBox(std::string_view path) const
+{
+	auto i = m_box.find(path);
+	return i == m_box.end() ? nullptr : &i->second;
+}
+
+inline DataBox* DataBox::findBox(std::string_view path)
+{
+	auto i = m_box.find(path);
+	return i == m_box.end() ? nullptr : &i->second;
+}
+
+inline const DataItem* DataBox::findItem(std::string_view path) const
+{
+	auto i = m_item.find(path);
+	return i == m_item.end() ? nullptr : &i->second;
+}
+
+inline DataItem* DataBox::findItem(std::string_view path)
+{
+	auto i = m_item.find(path);
+	return i == m_item.end() ? nullptr : &i->second;
+}
+
+template<typename T>
+inline std::optional<T> DataBox::tryGet(std::string_view path) const
+{
+	const DataItem* item = findItem(path);
+	if (!item)
+		return std::nullopt;
+	return item->tryAs<T>();
+}
+
+inline bool DataBox::box(std::string_view path) const
+{
+	// ߓIȔrcount()equal_range()ɂȂ̂ŁA1ōςfind()g
+	return m_box.find(path) != m_box.end();
+}
+
+inline bool DataBox::item(std::string_view path) const
+{
+	return m_item.find(path) != m_item.end();
 }
 
 inline void DataBox::add(const char* path, DataBox&& box)
 {
-	m_box.emplace(path, std::move(box));
+	add(std::string_view(path), std::move(box));
+}
+
+inline void DataBox::add(std::string_view path, DataBox&& box)
+{
+	beforeChange(DataChange::BOX);
+	adopt(assign(m_box, path, std::move(box)));
+}
+
+inline void DataBox::add(std::string&& path, DataBox&& box)
+{
+	beforeChange(DataChange::BOX);
+	adopt(assign(m_box, std::move(path), std::move(box)));
 }
 
 inline void DataBox::add(const char* path, DataItem&& item)
 {
-	m_item.emplace(path, std::move(item));
+	add(std::string_view(path), std::move(item));
+}
+
+inline void DataBox::add(std::string_view path, DataItem&& item)
+{
+	beforeChange(DataChange::BOX);
+	adopt(assign(m_item, path, std::move(item)));
+}
+
+inline void DataBox::add(std::string&& path, DataItem&& item)
+{
+	beforeChange(DataChange::BOX);
+	adopt(assign(m_item, std::move(path), std::move(item)));
+}
+
+inline bool DataBox::tryAdd(const char* path, DataBox&& box)
+{
+	return tryAdd(std::string_view(path), std::move(box));
+}
+
+inline bool DataBox::tryAdd(std::string_view path, DataBox&& box)
+{
+	DataBox* p = tryAssign(m_box, path, std::move(box));
+	if (p)
+		adopt(*p);
+	return p != nullptr;
+}
+
+inline bool DataBox::tryAdd(std::string&& path, DataBox&& box)
+{
+	DataBox* p = tryAssign(m_box, std::move(path), std::move(box));
+	if (p)
+		adopt(*p);
+	return p != nullptr;
+}
+
+inline bool DataBox::tryAdd(const char* path, DataItem&& item)
+{
+	return tryAdd(std::string_view(path), std::move(item));
+}
+
+inline bool DataBox::tryAdd(std::string_view path, DataItem&& item)
+{
+	DataItem* p = tryAssign(m_item, path, std::move(item));
+	if (p)
+		adopt(*p);
+	return p != nullptr;
+}
+
+inline bool DataBox::tryAdd(std::string&& path, DataItem&& item)
+{
+	DataItem* p = tryAssign(m_item, std::move(path), std::move(item));
+	if (p)
+		adopt(*p);
+	return p != nullptr;
+}
+
+inline void DataBox::add(std::vector<std::pair<std::string, DataBox>>&& boxes)
+{
+	beforeChange(DataChange::BOX);
+	for (auto& i : boxes)
+		assign(m_box, std::move(i.first), std::move(i.second)).m_hashParent = this;
+	invalidateHash();
+}
+
+inline void DataBox::add(std::vector<std::pair<std::string, DataItem>>&& items)
+{
+	beforeChange(DataChange::BOX);
+	for (auto& i : items)
+		assign(m_item, std::move(i.first), std::move(i.second)).m_hashParent = this;
+	invalidateHash();
+}
+
+inline bool DataBox::removeBox(std::string_view path)
+{
+	auto i = m_box.find(path);
+	if (i == m_box.end())
+		return false;
+
+	beforeChange(DataChange::BOX);
+	i->second.beforeChange(DataChange::SUBTREE);
+	m_box.erase(i);
+	invalidateHash();
+	return true;
+}
+
+inline bool DataBox::removeItem(std::string_view path)
+{
+	auto i = m_item.find(path);
+	if (i == m_item.end())
+		return false;
+
+	beforeChange(DataChange::BOX);
+	m_item.erase(i);
+	invalidateHash();
+	return true;
+}
+
+inline uint64_t DataBox::hash() const
+{
+	if (m_hashCache)
+		return m_hash;
+
+	// DataItemDataBoxœOĂʂł悤ɃV[hς
+	uint64_t h = 0;
+	for (auto& i : m_item)
+	{
+		h = DataHash::combine(h, DataHash::bytes(i.first.data(), i.first.size(), 1));
+		h = DataHash::combine(h, i.second.hash());
+	}
+	for (auto& i : m_box)
+	{
+		h = DataHash::combine(h, DataHash::bytes(i.first.data(), i.first.size(), 2));
+		h = DataHash::combine(h, i.second.hash());
+	}
+
+	m_hash = h;
+	m_hashCache = true;
+	return m_hash;
+}
+
+inline bool DataBox::equals(const DataBox& rhs) const
+{
+	if (this == &rhs)
+		return true;
+	if (hash() != rhs.hash() || m_item.size() != rhs.m_item.size() || m_box.size() != rhs.m_box.size())
+		return false;
+
+	// Oɕł̂Ő擪珇ɔׂ
+	for (auto i = m_item.begin(), j = rhs.m_item.begin(); i != m_item.end(); ++i, ++j)
+	{
+		if (i->first != j->first || !i->second.equals(j->second))
+			return false;
+	}
+	for (auto i = m_box.begin(), j = rhs.m_box.begin(); i != m_box.end(); ++i, ++j)
+	{
+		if (i->first != j->first || !i->second.equals(j->second))
+			return false;
+	}
+	return true;
+}
+
+inline DataBox::Range<DataBox::BoxMap::const_iterator> DataBox::boxes() const
+{
+	return Range<BoxMap::const_iterator>(m_box.begin(), m_box.end());
+}
+
+inline DataBox::Range<DataBox::BoxMap::iterator> DataBox::boxes()
+{
+	return Range<BoxMap::iterator>(m_box.begin(), m_box.end());
+}
+
+inline DataBox::Range<DataBox::ItemMap::const_iterator> DataBox::items() const
+{
+	return Range<ItemMap::const_iterator>(m_item.begin(), m_item.end());
+}
+
+inline DataBox::Range<DataBox::ItemMap::iterator> DataBox::items()
+{
+	return Range<ItemMap::iterator>(m_item.begin(), m_item.end());
+}
+
+inline DataBox::Range<DataBox::BoxMap::const_iterator> DataBox::boxes(std::string_view first, std::string_view last) const
+{
+	return nameRange(m_box, first, last);
+}
+
+inline DataBox::Range<DataBox::BoxMap::iterator> DataBox::boxes(std::string_view first, std::string_view last)
+{
+	return nameRange(m_box, first, last);
+}
+
+inline DataBox::Range<DataBox::ItemMap::const_iterator> DataBox::items(std::string_view first, std::string_view last) const
+{
+	return nameRange(m_item, first, last);
+}
+
+inline DataBox::Range<DataBox::ItemMap::iterator> DataBox::items(std::string_view first, std::string_view last)
+{
+	return nameRange(m_item, first, last);
+}
+
+inline DataBox::Range<DataBox::BoxMap::const_iterator> DataBox::boxesWithPrefix(std::string_view prefix) const
+{
+	return prefixRange(m_box, prefix);
+}
+
+inline DataBox::Range<DataBox::BoxMap::iterator> DataBox::boxesWithPrefix(std::string_view prefix)
+{
+	return prefixRange(m_box, prefix);
+}
+
+inline DataBox::Range<DataBox::ItemMap::const_iterator> DataBox::itemsWithPrefix(std::string_view prefix) const
+{
+	return prefixRange(m_item, prefix);
+}
+
+inline DataBox::Range<DataBox::ItemMap::iterator> DataBox::itemsWithPrefix(std::string_view prefix)
+{
+	return prefixRange(m_item, prefix);
+}
+
+template<typename Visitor>
+inline bool DataBox::visit(Visitor&& visitor) const
+{
+	for (auto& i : m_item)
+	{
+		if (visitor(i.first, i.second) == DataVisit::STOP)
+			return false;
+	}
+
+	for (auto& i : m_box)
+	{
+		DataVisit v = visitor(i.first, i.second);
+		if (v == DataVisit::STOP)
+			return false;
+		if (v == DataVisit::SKIP)
+			continue;
+		if (!i.second.visit(visitor))
+			return false;
+	}
+
+	return true;
 }
 
 inline bool DataBox::inputFile(const char* path)
@@ -157,50 +683,103 @@ inline bool DataBox::inputFile(const char* path)
 	if (!o)
 		return false;
 
-	clear();
-
-	std::string s((std::istreambuf_iterator<char>(o)), std::istreambuf_iterator<char>());
-	input(s);
+	std::string s;
+	{
+		FDA_TRACE_PHASE(DataTracePhase::READ);
+		s.assign((std::istreambuf_iterator<char>(o)), std::istreambuf_iterator<char>());
+	}
+	DataParseResult r = parse(s);
+	if (!r)
+		throw std::invalid_argument(std::string("DataBox: ") + r.message() + " at " + std::to_string(r.position));
 
 	return true;
 }
 
-inline bool DataBox::outputFile(const char* path) const
+inline DataParseResult DataBox::parse(std::string_view formatText)
+{
+	// sƂɏԒlύXȂ悤AʂDataBoxɓ͂Ăւ
+	DataBox box;
+	DataParseResult r = box.input(formatText, 0);
+	if (r)
+		*this = std::move(box);
+	return r;
+}
+
+inline bool DataBox::outputFile(const char* path, DataOutputStyle style) const
 {
 	std::ofstream o(path, std::ios::out);
 	if (!o)
 		return false;
 
-	std::string s = output();
-	o.write(s.c_str(), s.size());
+	std::string s;
+	{
+		FDA_TRACE_PHASE(DataTracePhase::FORMAT);
+		s = output(style);
+	}
+	{
+		FDA_TRACE_PHASE(DataTracePhase::WRITE);
+		o.write(s.c_str(), s.size());
+	}
 
 	return true;
 }
 
 inline void DataBox::clear()
 {
+	beforeChange(DataChange::SUBTREE);
 	m_box.clear();
 	m_item.clear();
+	invalidateHash();
 }
 
-inline void DataBox::input(const std::string& formatText)
+inline void DataBox::intern(DataInternPool& pool)
 {
-	const unsigned char* text = reinterpret_cast<const unsigned char*>(formatText.c_str());
+	for (auto& i : m_item)
+		i.second.intern(pool);
+	for (auto& i : m_box)
+		i.second.intern(pool);
+}
+
+inline void DataBox::adopt(DataBox& box)
+{
+	box.m_hashParent = this;
+	invalidateHash();
+}
+
+inline void DataBox::adopt(DataItem& item)
+{
+	item.m_hashParent = this;
+	invalidateHash();
+}
+
+inline void DataBox::adoptChildren()
+{
+	// qDataBoxDataItemstd::map̃m[hƈړ̂ŃAhX͕ςȂAẽAhX͕ς
+	for (auto& i : m_box)
+		i.second.m_hashParent = this;
+	for (auto& i : m_item)
+		i.second.m_hashParent = this;
+}
+
+inline DataParseResult DataBox::input(std::string_view formatText, size_t offset)
+{
+	FDA_TRACE_PHASE(DataTracePhase::SCAN);
+
+	const unsigned char* text = reinterpret_cast<const unsigned char*>(formatText.data());
 	int size = formatText.size();
 
 	/// <summary>
 	/// <para>SppȂw肵p̃CfbNX</para>
-	/// <para>pOɕ̍ŌɓBO</para>
 	/// </summary>
 	/// <param name="start">JnCfbNX</param>
 	/// <param name="sbc">p</param>
-	/// <returns>ŏɌp̃CfbNX</returns>
+	/// <returns>ŏɌp̃CfbNX, -1=Oɕ̍ŌɓB</returns>
 	auto foundSBC = [text, size](int start, char sbc)
 	{
 		while (true)
 		{
 			if (start >= size)
-				throw;
+				return -1;
 			if (_mbclen(text + start) == 2)
 			{
 				start += 2;
@@ -229,16 +808,25 @@ inline void DataBox::input(const std::string& formatText)
 		{
 			// Ή^O̃CfbNX擾
 			int j = foundSBC(i + 1, ')');
+			if (j < 0)
+				return DataParseResult(DataError::UNTERMINATED, offset + i);
 
 			// sCfbNX擾
 			int k = foundSBC(j + 1, '\n');
+			if (k < 0)
+				return DataParseResult(DataError::UNTERMINATED, offset + j + 1);
 
 			// ̏
 			// i            j     k
 			// (DataItemName)Value
 
 			// add("DataItemName", DataItem("Value");
-			add(formatText.substr(i + 1, j - i - 1).c_str(), DataItem::createFromFormat(formatText.substr(j + 1, k - j - 1).c_str()));
+			FDA_TRACE_PHASE(DataTracePhase::BUILD);
+			DataItem item;
+			DataParseResult r = DataItem::tryCreateFromFormat(std::string(formatText.substr(j + 1, k - j - 1)).c_str(), item);
+			if (!r)
+				return DataParseResult(r.error, offset + j + 1 + r.position);
+			add(formatText.substr(i + 1, j - i - 1), std::move(item));
 
 			// ++îłŉswĂƒx
 			i = k;
@@ -249,24 +837,30 @@ inline void DataBox::input(const std::string& formatText)
 		{
 			// Ή^O̃CfbNX擾
 			int j = foundSBC(i + 1, ']');
+			if (j < 0)
+				return DataParseResult(DataError::UNTERMINATED, offset + i);
 
 			// ̏
 			// i           j
 			// [DataBoxName]
 
-			// std::string name = "DataBoxName";
-			std::string name = formatText.substr(i + 1, j - i - 1);
+			// std::string_view name = "DataBoxName";
+			std::string_view name = formatText.substr(i + 1, j - i - 1);
 
-			// [DataBoxName]ɑΉ[/DataBoxName]
-			// [DataBoxName][DataBoxName][/DataBoxName][/DataBoxName]̂悤ȓqɂΉ
+			// JĂȂDataBox̕^OȂ玸s
+			if (!name.empty() && name[0] == '/')
+				return DataParseResult(DataError::UNCLOSED_BOX, offset + i);
+
+			// [DataBoxName]ɑΉ[/DataBoxName]܂[/]
+			// Oׂ͔AJ^Oƕ^O̐œq𐔂
 			int c = 1;
 			int k = j + 1;
 			int l = 0;
 			while (true)
 			{
-				// [/DataBoxName]OformatTextIO
+				// [/DataBoxName]OformatTextI玸s
 				if (k >= size)
-					throw;
+					return DataParseResult(DataError::UNCLOSED_BOX, offset + i);
 
 				// Sp͓ǂݔ΂
 				if (_mbclen(text + k) == 2)
@@ -275,52 +869,61 @@ inline void DataBox::input(const std::string& formatText)
 					continue;
 				}
 
+				// DataItem̒l'['']'܂ł悢̂ŁADataItem̍s͉s܂œǂݔ΂
+				if (text[k] == '(')
+				{
+					l = foundSBC(k + 1, '\n');
+					if (l < 0)
+						return DataParseResult(DataError::UNCLOSED_BOX, offset + i);
+					k = l + 1;
+					continue;
+				}
+
 				// DataBox̃^OƂ
 				if (text[k] == '[')
 				{
-					// ̕ȂΗO
+					// ̕ȂΎs
 					if (k + 1 >= size)
-						throw;
+						return DataParseResult(DataError::UNCLOSED_BOX, offset + i);
 
 					// ̕'/'ꍇ
 					if (_mbclen(text + k + 1) == 1 && text[k + 1] == '/')
 					{
 						// Ή^O̃CfbNX擾
 						l = foundSBC(k + 2, ']');
+						if (l < 0)
+							return DataParseResult(DataError::UNTERMINATED, offset + k);
 
 						// ̏
 						// k            l
 						// [/DataBoxName]
 
-						// std::string name2 = "DataBoxName";
-						std::string name2 = formatText.substr(k + 2, l - k - 2);
-
-						if (name == name2)
+						// qJEg炷
+						// [ɂȂ[DataBoxName]ɑΉ^OƂ
+						if (--c == 0)
 						{
-							// OvqJEg炷
-							--c;
+							// Ô^O͖OvȂΎs
+							std::string_view name2 = formatText.substr(k + 2, l - k - 2);
+							if (!name2.empty() && name != name2)
+								return DataParseResult(DataError::UNCLOSED_BOX, offset + i);
 
-							// [ɂȂ[DataBoxName]ɑΉ[/DataBoxName]Ƃ
 							// I
-							if (c == 0)
-								break;
+							break;
 						}
 					}
 					else
 					{
 						// Ή^O̃CfbNX擾
 						l = foundSBC(k + 1, ']');
+						if (l < 0)
+							return DataParseResult(DataError::UNTERMINATED, offset + k);
 
 						// ̏
 						// k           l
 						// [DataBoxName]
 
-						// std::string name2 = "DataBoxName";
-						std::string name2 = formatText.substr(k + 1, l - k - 1);
-
-						// OvqJEg𑝂₷
-						if (name == name2)
-							++c;
+						// qJEg𑝂₷
+						++c;
 					}
 
 					// ++k̂ł']'wĂƒx
@@ -329,9 +932,9 @@ inline void DataBox::input(const std::string& formatText)
 				++k;
 			}
 
-			// ɎsO
+			// Ή^OȂΎs
 			if (c != 0)
-				throw;
+				return DataParseResult(DataError::UNCLOSED_BOX, offset + i);
 
 			// ̏
 			// i           j
@@ -340,13 +943,18 @@ inline void DataBox::input(const std::string& formatText)
 			//   ()
 			// 
 			// k            l
-			// [/DataBoxName]
+			// [/DataBoxName] ܂ [/]
 
 			// DataBoxNameƂODataBox̒g͍ċAIɐݒ肷OK
 			// box.input("()");
 			DataBox box;
-			box.input(formatText.substr(j + 1, k - j - 1));
-			add(name.c_str(), std::move(box));
+			DataParseResult r = box.input(formatText.substr(j + 1, k - j - 1), offset + j + 1);
+			if (!r)
+				return r;
+			{
+				FDA_TRACE_PHASE(DataTracePhase::BUILD);
+				add(name, std::move(box));
+			}
 
 			// ++îł']'wĂƒx
 			i = l;
@@ -354,24 +962,148 @@ inline void DataBox::input(const std::string& formatText)
 
 		++i;
 	}
+
+	return DataParseResult();
+}
+
+inline std::string DataBox::output(DataOutputStyle style) const
+{
+	std::string s;
+	output(s, std::string(), style, [](std::string&) {});
+	return s;
 }
 
-inline std::string DataBox::output(const std::string& indent) const
+template<typename Flush>
+inline void DataBox::output(std::string& text, const std::string& indent, DataOutputStyle style, Flush&& flush) const
 {
-	std::stringstream s;
+	output(text, indent, style, flush, [](const DataBox&, std::string&, const std::string&) { return false; });
+}
 
+template<typename Flush, typename Child>
+inline void DataBox::output(std::string& text, const std::string& indent, DataOutputStyle style, Flush&& flush, Child&& child) const
+{
 	for (auto& i : m_item)
-		s << indent << '(' << i.first << ')' << i.second() << '\n';
+	{
+		text += indent;
+		text += '(';
+		text += i.first;
+		text += ')';
+		text += i.second();
+		text += '\n';
+		flush(text);
+	}
 
-	std::string n = indent + "  ";
+	bool minified = style == DataOutputStyle::MINIFIED;
+	std::string n = minified ? indent : indent + "  ";
 
 	for (auto& i : m_box)
 	{
-		s << indent << '[' << i.first << "]\n";
-		s << i.second.output(n);
-		s << indent << "[/" << i.first << "]\n";
+		text += indent;
+		text += '[';
+		text += i.first;
+		text += "]\n";
+		if (!child(i.second, text, n))
+			i.second.output(text, n, style, flush, child);
+		text += indent;
+		if (minified)
+		{
+			text += "[/]\n";
+		}
+		else
+		{
+			text += "[/";
+			text += i.first;
+			text += "]\n";
+		}
+		flush(text);
 	}
+}
 
-	return s.str();
+template<typename Map>
+inline typename Map::mapped_type& DataBox::at(Map& map, std::string_view path)
+{
+	auto i = map.find(path);
+	if (i == map.end())
+		throw std::out_of_range("DataBox: path not found " + std::string(path));
+	return i->second;
+}
+
+template<typename Map>
+inline const typename Map::mapped_type& DataBox::at(const Map& map, std::string_view path)
+{
+	auto i = map.find(path);
+	if (i == map.end())
+		throw std::out_of_range("DataBox: path not found " + std::string(path));
+	return i->second;
+}
+
+template<typename Map, typename Key, typename Value>
+inline Value& DataBox::assign(Map& map, Key&& path, Value&& value)
+{
+	// t@CǂݍޏꍇȂǂ͖Oɒǉ̂ŁAȂTȂ
+	auto i = map.end();
+	if (!map.empty() && !(std::prev(i)->first < path))
+	{
+		i = map.lower_bound(path);
+		if (i != map.end() && i->first == path)
+		{
+			i->second = std::move(value);
+			return i->second;
+		}
+	}
+	return map.emplace_hint(i, std::forward<Key>(path), std::move(value))->second;
+}
+
+template<typename Map, typename Key, typename Value>
+inline Value* DataBox::tryAssign(Map& map, Key&& path, Value&& value)
+{
+	// assign()ƓȂTȂ
+	auto i = map.end();
+	if (!map.empty() && !(std::prev(i)->first < path))
+	{
+		i = map.lower_bound(path);
+		if (i != map.end() && i->first == path)
+			return nullptr;
+	}
+	beforeChange(DataChange::BOX);
+	return &map.emplace_hint(i, std::forward<Key>(path), std::move(value))->second;
+}
+
+template<typename Map>
+inline DataBox::Range<typename Map::iterator> DataBox::nameRange(Map& map, std::string_view first, std::string_view last)
+{
+	// lastfirstȉ̏ꍇɋt͈̔͂Ȃ悤AIn܂ɑ
+	auto i = map.lower_bound(first);
+	return Range<typename Map::iterator>(i, last <= first ? i : map.lower_bound(last));
+}
+
+template<typename Map>
+inline DataBox::Range<typename Map::const_iterator> DataBox::nameRange(const Map& map, std::string_view first, std::string_view last)
+{
+	auto i = map.lower_bound(first);
+	return Range<typename Map::const_iterator>(i, last <= first ? i : map.lower_bound(last));
+}
+
+template<typename Map>
+inline DataBox::Range<typename Map::iterator> DataBox::prefixRange(Map& map, std::string_view prefix)
+{
+	// Oɕł̂ŁAprefixȏ̍ŏ̖OprefixŎn܂ȂȂ܂ł͈
+	size_t n = prefix.size();
+	auto first = map.lower_bound(prefix);
+	auto last = first;
+	while (last != map.end() && last->first.compare(0, n, prefix) == 0)
+		++last;
+	return Range<typename Map::iterator>(first, last);
+}
+
+template<typename Map>
+inline DataBox::Range<typename Map::const_iterator> DataBox::prefixRange(const Map& map, std::string_view prefix)
+{
+	size_t n = prefix.size();
+	auto first = map.lower_bound(prefix);
+	auto last = first;
+	while (last != map.end() && last->first.compare(0, n, prefix) == 0)
+		++last;
+	return Range<typename Map::const_iterator>(first, last);
 }
 
@@ -0,0 +1,724 @@
+#pragma once
+
+#include "DataError.h"
+#include "DataSimd.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/// <summary>
+/// <para>DataFormat::PACKEDŔz̒ll߂@</para>
+/// <para>RAW=̂܂܂̃oCg</para>
+/// <para>VARINT=evfzig-zagϊϒ (Βl̏Ȓl)</para>
+/// <para>DELTA_VARINT=O̗vfƂ̍zig-zagϊϒ (IDEȂǒPɑl)</para>
+/// <para>FOR=ŏlƂ̍𓯂rbg (1ȏ) ŋl߂ (͈͂̋l)</para>
+/// <para>DELTA_FOR=擪̒lƁAO̗vfƂ̍FORŋl߂ (قڈ̊Ԋuől)</para>
+/// <para>LZ=OɌꂽoCg̎QƂŏk߂ (тJԂl)</para>
+/// </summary>
+enum class DataCodecType
+{
+	RAW,
+	VARINT,
+	DELTA_VARINT,
+	FOR,
+	DELTA_FOR,
+	LZ
+};
+
+/// <summary>
+/// <para>DataFormat::PACKEDŎgAz̒lƃoCg𑊌݂ɕϊ֐Q</para>
+/// <para>evf͌^̃TCY̕tƂĈ (̓rbg𐮐ƂĈ)</para>
+/// <para>2^64@ƂČvẐŁA܂߂ǂ̒lɖ߂</para>
+/// <para>lߕ𑝂₷ꍇ́ADataCodecTypeɉname()encode()Edecode()̕ɉ</para>
+/// </summary>
+class DataCodec
+{
+public:
+	/// <summary>
+	/// <para>decode()oCg̖𒴂ēǂރoCg</para>
+	/// <para>oCǧɂ̑傫̓ǂ߂̈pӂ邱</para>
+	/// </summary>
+	static const size_t PADDING = 8;
+
+	/// <summary>
+	/// <para>decode()Ŗ߂oCg (^̃TCY~vf) ̏</para>
+	/// <para>ɏꂽvfŋȗ̈mۂȂ悤AmaxCount()͂𒴂ȂlԂ</para>
+	/// </summary>
+	static const size_t MAX_DECODED_SIZE = size_t(1) << 30;
+
+	/// <summary>
+	/// <para>łȂlߕIŋl߁Abytes̖ɒǉ</para>
+	/// <para>̋lߕ̑傫͒l1񑖍ČvZAȉɂȂȂꍇLZ</para>
+	/// </summary>
+	/// <returns>I񂾋lߕ</returns>
+	static DataCodecType encode(size_t elementSize, size_t elementCount, const void* data, std::string& bytes);
+
+	/// <summary>
+	/// <para>typeŋl߂bytes̖ɒǉ</para>
+	/// <para>^̃TCY1,2,4,8ȊOƗO</para>
+	/// </summary>
+	static void encode(DataCodecType type, size_t elementSize, size_t elementCount, const void* data, std::string& bytes);
+
+	/// <summary>
+	/// <para>typeŋl߂sizeoCgɖ߂Adataɏ</para>
+	/// <para>dataɂ͌^̃TCY~vf̗̈悪邱</para>
+	/// </summary>
+	/// <returns>sꍇAINVALID_VALUEbytes̐擪̈ʒu</returns>
+	static DataParseResult decode(DataCodecType type, size_t elementSize, size_t elementCount, const uint8_t* bytes, size_t size, void* data);
+
+	/// <summary>
+	/// <para>typeŋl߂sizeoCg߂vf̏ (^̃TCY~vfMAX_DECODED_SIZEȉ)</para>
+	/// <para>decode()̑OɁAɏꂽvfŗ̈mۂȂ悤m߂邽߂Ɏg</para>
+	/// </summary>
+	static size_t maxCount(DataCodecType type, size_t elementSize, size_t size);
+
+	/// <returns>ɏlߕ̖O</returns>
+	static const char* name(DataCodecType type);
+
+	/// <summary>
+	/// <para>length̖OlߕT</para>
+	/// </summary>
+	/// <returns>true=</returns>
+	static bool find(const char* name, size_t length, DataCodecType& type);
+
+private:
+	template<typename U>
+	static DataCodecType choose(const U* data, size_t count, size_t& size);
+
+	template<typename U>
+	static void encodeValues(DataCodecType type, const U* data, size_t count, std::string& bytes);
+
+	template<typename U>
+	static DataParseResult decodeValues(DataCodecType type, const uint8_t* bytes, size_t size, U* data, size_t count);
+
+	template<typename U, bool Delta>
+	static void encodeFor(const U* data, size_t count, std::string& bytes);
+
+	template<typename U, bool Delta>
+	static DataParseResult decodeFor(const uint8_t* bytes, size_t size, U* data, size_t count);
+
+	template<typename U>
+	static DataParseResult decodeVarint(const uint8_t* bytes, size_t size, U* data, size_t count, bool delta);
+
+	/// <summary>
+	/// <para>擪firstԖڈȍ~countwrbg̒lo</para>
+	/// </summary>
+	static void unpack(const uint8_t* bits, size_t first, size_t count, int w, uint64_t* values);
+
+	static void compress(const uint8_t* data, size_t size, std::string& bytes);
+	static DataParseResult decompress(const uint8_t* bytes, size_t size, uint8_t* data, size_t dataSize);
+
+	/// <returns>^̃TCY̕tƂēǂ񂾒l64rbgɍL</returns>
+	template<typename U>
+	static uint64_t widen(U value);
+
+	static uint64_t zigzag(uint64_t value);
+	static uint64_t unzigzag(uint64_t value);
+	static size_t varintSize(uint64_t value);
+	static void putVarint(uint64_t value, std::string& bytes);
+	static void put64(uint64_t value, std::string& bytes);
+	static uint64_t load64(const uint8_t* p);
+	static int width(uint64_t value);
+
+	/// <returns>FOREDELTA_FORŔ͈range̒ll߂rbg</returns>
+	static int packedWidth(uint64_t range);
+};
+
+
+
+
+inline DataCodecType DataCodec::encode(size_t elementSize, size_t elementCount, const void* data, std::string& bytes)
+{
+	size_t size = 0;
+	DataCodecType type;
+	switch (elementSize)
+	{
+	case 1: type = choose(static_cast<const uint8_t*>(data), elementCount, size); break;
+	case 2: type = choose(static_cast<const uint16_t*>(data), elementCount, size); break;
+	case 4: type = choose(static_cast<const uint32_t*>(data), elementCount, size); break;
+	case 8: type = choose(static_cast<const uint64_t*>(data), elementCount, size); break;
+	default: throw std::invalid_argument("DataCodec: unsupported element size");
+	}
+
+	// LZ͎ۂɏk߂ȂƑ傫Ȃ̂ŁA̋lߕŏk܂Ȃꍇ
+	size_t raw = elementSize * elementCount;
+	if (size * 2 > raw)
+	{
+		size_t n = bytes.size();
+		compress(static_cast<const uint8_t*>(data), raw, bytes);
+		if (bytes.size() - n < size)
+			return DataCodecType::LZ;
+		bytes.resize(n);
+	}
+
+	encode(type, elementSize, elementCount, data, bytes);
+	return type;
+}
+
+inline void DataCodec::encode(DataCodecType type, size_t elementSize, size_t elementCount, const void* data, std::string& bytes)
+{
+	if (type == DataCodecType::LZ)
+	{
+		if (elementSize != 1 && elementSize != 2 && elementSize != 4 && elementSize != 8)
+			throw std::invalid_argument("DataCodec: unsupported element size");
+		compress(static_cast<const uint8_t*>(data), elementSize * elementCount, bytes);
+		return;
+	}
+
+	switch (elementSize)
+	{
+	case 1: encodeValues(type, static_cast<const uint8_t*>(data), elementCount, bytes); break;
+	case 2: encodeValues(type, static_cast<const uint16_t*>(data), elementCount, bytes); break;
+	case 4: encodeValues(type, static_cast<const uint32_t*>(data), elementCount, bytes); break;
+	case 8: encodeValues(type, static_cast<const uint64_t*>(data), elementCount, bytes); break;
+	default: throw std::invalid_argument("DataCodec: unsupported element size");
+	}
+}
+
+inline DataParseResult DataCodec::decode(DataCodecType type, size_t elementSize, size_t elementCount, const uint8_t* bytes, size_t size, void* data)
+{
+	if (type == DataCodecType::LZ)
+		return decompress(bytes, size, static_cast<uint8_t*>(data), elementSize * elementCount);
+
+	switch (elementSize)
+	{
+	case 1: return decodeValues(type, bytes, size, static_cast<uint8_t*>(data), elementCount);
+	case 2: return decodeValues(type, bytes, size, static_cast<uint16_t*>(data), elementCount);
+	case 4: return decodeValues(type, bytes, size, static_cast<uint32_t*>(data), elementCount);
+	case 8: return decodeValues(type, bytes, size, static_cast<uint64_t*>(data), elementCount);
+	default: return DataParseResult(DataError::UNSUPPORTED_SIZE, 0);
+	}
+}
+
+inline size_t DataCodec::maxCount(DataCodecType type, size_t elementSize, size_t size)
+{
+	// elߕ1vfɎgŏ̃oCgErbg狁߂
+	// |ZӂȂ悤AMAX_DECODED_SIZEŗ}
+	auto times = [](size_t n, size_t k) { return n > MAX_DECODED_SIZE / k ? MAX_DECODED_SIZE : n * k; };
+	size_t count;
+	switch (type)
+	{
+	case DataCodecType::RAW: count = size / elementSize; break;
+	case DataCodecType::VARINT:
+	case DataCodecType::DELTA_VARINT: count = size; break;
+	case DataCodecType::FOR: count = size < 9 ? 0 : times(size - 9, 8); break;
+	case DataCodecType::DELTA_FOR: count = size < 17 ? 0 : 1 + times(size - 17, 8); break;
+	// ΂1oCgōő255oCgo͂
+	case DataCodecType::LZ: count = times(size, 255) / elementSize; break;
+	default: return 0;
+	}
+	return (std::min)(count, MAX_DECODED_SIZE / elementSize);
+}
+
+inline const char* DataCodec::name(DataCodecType type)
+{
+	switch (type)
+	{
+	case DataCodecType::RAW: return "raw";
+	case DataCodecType::VARINT: return "v";
+	case DataCodecType::DELTA_VARINT: return "dv";
+	case DataCodecType::FOR: return "f";
+	case DataCodecType::DELTA_FOR: return "df";
+	case DataCodecType::LZ: return "lz";
+	default: throw std::invalid_argument("DataCodec: unsupported codec");
+	}
+}
+
+inline bool DataCodec::find(const char* name, size_t length, DataCodecType& type)
+{
+	static const DataCodecType types[] = {DataCodecType::RAW, DataCodecType::VARINT, DataCodecType::DELTA_VARINT, DataCodecType::FOR, DataCodecType::DELTA_FOR, DataCodecType::LZ};
+	for (DataCodecType t : types)
+	{
+		const char* n = DataCodec::name(t);
+		if (strlen(n) == length && memcmp(n, name, length) == 0)
+		{
+			type = t;
+			return true;
+		}
+	}
+	return false;
+}
+
+template<typename U>
+inline DataCodecType DataCodec::choose(const U* data, size_t count, size_t& size)
+{
+	// SĂ̋lߕ̑傫1̑ŌvZ
+	uint64_t lo = widen(data[0]);
+	uint64_t hi = lo;
+	uint64_t deltaLo = 0;
+	uint64_t deltaHi = 0;
+	size_t varint = 0;
+	size_t deltaVarint = 0;
+	uint64_t previous = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		uint64_t v = widen(data[i]);
+		uint64_t d = v - previous;
+		varint += varintSize(zigzag(v));
+		deltaVarint += varintSize(zigzag(d));
+		if (static_cast<int64_t>(v) < static_cast<int64_t>(lo))
+			lo = v;
+		if (static_cast<int64_t>(v) > static_cast<int64_t>(hi))
+			hi = v;
+		if (i == 1)
+		{
+			deltaLo = d;
+			deltaHi = d;
+		}
+		else if (i > 1)
+		{
+			if (static_cast<int64_t>(d) < static_cast<int64_t>(deltaLo))
+				deltaLo = d;
+			if (static_cast<int64_t>(d) > static_cast<int64_t>(deltaHi))
+				deltaHi = d;
+		}
+		previous = v;
+	}
+
+	// 傫ȂWJ̑̂I
+	const struct
+	{
+		DataCodecType type;
+		size_t size;
+	} candidates[] = {
+		{DataCodecType::RAW, sizeof(U) * count},
+		{DataCodecType::FOR, 9 + (count * packedWidth(hi - lo) + 7) / 8},
+		{DataCodecType::DELTA_FOR, 17 + ((count - 1) * packedWidth(deltaHi - deltaLo) + 7) / 8},
+		{DataCodecType::VARINT, varint},
+		{DataCodecType::DELTA_VARINT, deltaVarint},
+	};
+
+	DataCodecType type = candidates[0].type;
+	size = candidates[0].size;
+	for (auto& c : candidates)
+	{
+		if (c.size < size)
+		{
+			type = c.type;
+			size = c.size;
+		}
+	}
+	return type;
+}
+
+template<typename U>
+inline void DataCodec::encodeValues(DataCodecType type, const U* data, size_t count, std::string& bytes)
+{
+	switch (type)
+	{
+	case DataCodecType::RAW:
+		bytes.append(reinterpret_cast<const char*>(data), sizeof(U) * count);
+		break;
+	case DataCodecType::VARINT:
+		for (size_t i = 0; i < count; ++i)
+			putVarint(zigzag(widen(data[i])), bytes);
+		break;
+	case DataCodecType::DELTA_VARINT:
+	{
+		uint64_t previous = 0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			uint64_t v = widen(data[i]);
+			putVarint(zigzag(v - previous), bytes);
+			previous = v;
+		}
+	}
+	break;
+	case DataCodecType::FOR:
+		encodeFor<U, false>(data, count, bytes);
+		break;
+	case DataCodecType::DELTA_FOR:
+		encodeFor<U, true>(data, count, bytes);
+		break;
+	default:
+		throw std::invalid_argument("DataCodec: unsupported codec");
+	}
+}
+
+template<typename U>
+inline DataParseResult DataCodec::decodeValues(DataCodecType type, const uint8_t* bytes, size_t size, U* data, size_t count)
+{
+	switch (type)
+	{
+	case DataCodecType::RAW:
+		if (size != sizeof(U) * count)
+			return DataParseResult(DataError::INVALID_VALUE, size < sizeof(U) * count ? size : sizeof(U) * count);
+		memcpy(data, bytes, size);
+		return DataParseResult();
+	case DataCodecType::VARINT:
+		return decodeVarint(bytes, size, data, count, false);
+	case DataCodecType::DELTA_VARINT:
+		return decodeVarint(bytes, size, data, count, true);
+	case DataCodecType::FOR:
+		return decodeFor<U, false>(bytes, size, data, count);
+	case DataCodecType::DELTA_FOR:
+		return decodeFor<U, true>(bytes, size, data, count);
+	default:
+		return DataParseResult(DataError::INVALID_VALUE, 0);
+	}
+}
+
+template<typename U, bool Delta>
+inline void DataCodec::encodeFor(const U* data, size_t count, std::string& bytes)
+{
+	// DELTA_FOR͐擪̒l̂܂܏A2Ԗڈȍ~̗vf̍l߂
+	size_t first = Delta ? 1 : 0;
+	auto value = [data](size_t i) { return Delta ? widen(data[i]) - widen(data[i - 1]) : widen(data[i]); };
+
+	uint64_t lo = 0;
+	uint64_t hi = 0;
+	for (size_t i = first; i < count; ++i)
+	{
+		uint64_t v = value(i);
+		if (i == first || static_cast<int64_t>(v) < static_cast<int64_t>(lo))
+			lo = v;
+		if (i == first || static_cast<int64_t>(v) > static_cast<int64_t>(hi))
+			hi = v;
+	}
+	int w = packedWidth(hi - lo);
+
+	if (Delta)
+		put64(widen(data[0]), bytes);
+	put64(lo, bytes);
+	bytes.push_back(static_cast<char>(w));
+
+	// ʃrbg珇ɋl߂
+	uint64_t word = 0;
+	int bits = 0;
+	for (size_t i = first; i < count; ++i)
+	{
+		uint64_t v = value(i) - lo;
+		word |= v << bits;
+		bits += w;
+		if (bits >= 64)
+		{
+			put64(word, bytes);
+			bits -= 64;
+			word = bits == 0 ? 0 : v >> (w - bits);
+		}
+	}
+	for (int i = 0; i < bits; i += 8)
+		bytes.push_back(static_cast<char>(word >> i));
+}
+
+template<typename U, bool Delta>
+inline DataParseResult DataCodec::decodeFor(const uint8_t* bytes, size_t size, U* data, size_t count)
+{
+	size_t first = Delta ? 1 : 0;
+	size_t header = Delta ? 17 : 9;
+	if (size < header)
+		return DataParseResult(DataError::INVALID_VALUE, size);
+
+	uint64_t previous = Delta ? load64(bytes) : 0;
+	uint64_t lo = load64(bytes + header - 9);
+	int w = bytes[header - 1];
+	if (w == 0 || w > 64)
+		return DataParseResult(DataError::INVALID_VALUE, header - 1);
+	if (((count - first) * w + 7) / 8 != size - header)
+		return DataParseResult(DataError::INVALID_VALUE, size);
+
+	if (Delta)
+		data[0] = static_cast<U>(previous);
+
+	// olꎞ̈ɒuAŏl𑫂(DELTA_FOR͑O̒lɂ)
+	const uint8_t* bits = bytes + header;
+	uint64_t values[256];
+	for (size_t i = first; i < count; i += 256)
+	{
+		size_t n = count - i < 256 ? count - i : 256;
+		unpack(bits, i - first, n, w, values);
+		if (Delta)
+		{
+			for (size_t j = 0; j < n; ++j)
+			{
+				previous += lo + values[j];
+				data[i + j] = static_cast<U>(previous);
+			}
+		}
+		else
+		{
+			for (size_t j = 0; j < n; ++j)
+				data[i + j] = static_cast<U>(lo + values[j]);
+		}
+	}
+	return DataParseResult();
+}
+
+template<typename U>
+inline DataParseResult DataCodec::decodeVarint(const uint8_t* bytes, size_t size, U* data, size_t count, bool delta)
+{
+	const uint8_t* p = bytes;
+	const uint8_t* end = bytes + size;
+	uint64_t previous = 0;
+	size_t i = 0;
+	while (i < count)
+	{
+		// ̃rbgĂȂ8oCg1oCg̒lƂĂ܂Ƃ߂ēWJ
+		if (end - p >= 8 && count - i >= 8 && (load64(p) & 0x8080808080808080ULL) == 0)
+		{
+			for (size_t j = 0; j < 8; ++j)
+			{
+				uint64_t v = unzigzag(p[j]);
+				previous = delta ? previous + v : v;
+				data[i + j] = static_cast<U>(previous);
+			}
+			p += 8;
+			i += 8;
+			continue;
+		}
+
+		uint64_t v = 0;
+		for (int shift = 0;; shift += 7)
+		{
+			if (p == end || shift > 63)
+				return DataParseResult(DataError::INVALID_VALUE, static_cast<size_t>(p - bytes));
+			uint8_t b = *p++;
+			v |= static_cast<uint64_t>(b & 0x7F) << shift;
+			if ((b & 0x80) == 0)
+				break;
+		}
+		v = unzigzag(v);
+		previous = delta ? previous + v : v;
+		data[i++] = static_cast<U>(previous);
+	}
+
+	if (p != end)
+		return DataParseResult(DataError::INVALID_VALUE, static_cast<size_t>(p - bytes));
+	return DataParseResult();
+}
+
+inline void DataCodec::unpack(const uint8_t* bits, size_t first, size_t count, int w, uint64_t* values)
+{
+	if (w == 0)
+	{
+		memset(values, 0, sizeof(uint64_t) * count);
+		return;
+	}
+
+	uint64_t mask = w == 64 ? ~0ULL : (1ULL << w) - 1;
+	size_t i = 0;
+#if defined(FDA_SIMD_AVX2)
+	// 56rbgȉȂel͎g̐擪̃oCg8oCg̒Ɏ܂̂ŁA4̒lxɏW߂Ă炷
+	if (w <= 56)
+	{
+		const __m256i m = _mm256_set1_epi64x(static_cast<long long>(mask));
+		const __m256i seven = _mm256_set1_epi64x(7);
+		const __m256i step = _mm256_set1_epi64x(static_cast<long long>(4 * w));
+		__m256i position = _mm256_setr_epi64x(
+			static_cast<long long>(first * w), static_cast<long long>((first + 1) * w),
+			static_cast<long long>((first + 2) * w), static_cast<long long>((first + 3) * w));
+		for (; i + 4 <= count; i += 4)
+		{
+			__m256i v = _mm256_i64gather_epi64(reinterpret_cast<const long long*>(bits), _mm256_srli_epi64(position, 3), 1);
+			v = _mm256_srlv_epi64(v, _mm256_and_si256(position, seven));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(values + i), _mm256_and_si256(v, m));
+			position = _mm256_add_epi64(position, step);
+		}
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		size_t position = (first + i) * w;
+		size_t shift = position % 8;
+		uint64_t v = load64(bits + position / 8) >> shift;
+		if (shift + w > 64)
+			v |= static_cast<uint64_t>(bits[position / 8 + 8]) << (64 - shift);
+		values[i] = v & mask;
+	}
+}
+
+inline void DataCodec::compress(const uint8_t* data, size_t size, std::string& bytes)
+{
+	// ؂育Ƃ [̑g 1oCg][e][ 2oCg][v̒̑] ƕׂ
+	// ̑g͏4rbge̒A4rbgv̒-4ŁA15̏ꍇ͑oCg255Ă
+	// Ō̋؂̓eŏI
+	auto length = [&bytes](size_t n)
+	{
+		for (; n >= 255; n -= 255)
+			bytes.push_back(static_cast<char>(255));
+		bytes.push_back(static_cast<char>(n));
+	};
+	auto literal = [&](size_t anchor, size_t n, size_t match)
+	{
+		uint8_t token = static_cast<uint8_t>((n < 15 ? n : 15) << 4);
+		if (match != 0)
+			token |= static_cast<uint8_t>(match - 4 < 15 ? match - 4 : 15);
+		bytes.push_back(static_cast<char>(token));
+		if (n >= 15)
+			length(n - 15);
+		bytes.append(reinterpret_cast<const char*>(data + anchor), n);
+	};
+
+	const int HASH_BITS = 16;
+	std::vector<uint32_t> table(static_cast<size_t>(1) << HASH_BITS, 0);
+	size_t anchor = 0;
+	size_t i = 0;
+	while (i + 4 <= size)
+	{
+		uint32_t sequence;
+		memcpy(&sequence, data + i, 4);
+		uint32_t h = (sequence * 2654435761u) >> (32 - HASH_BITS);
+		size_t candidate = table[h];
+		table[h] = static_cast<uint32_t>(i);
+
+		uint32_t found;
+		memcpy(&found, data + candidate, 4);
+		if (candidate >= i || i - candidate > 0xFFFF || i > 0xFFFFFFFF || found != sequence)
+		{
+			// vȂԂ͏΂āAk܂Ȃf[^ɎԂȂ
+			i += 1 + ((i - anchor) >> 6);
+			continue;
+		}
+
+		size_t match = 4;
+		while (i + match < size && data[candidate + match] == data[i + match])
+			++match;
+
+		literal(anchor, i - anchor, match);
+		size_t distance = i - candidate;
+		bytes.push_back(static_cast<char>(distance));
+		bytes.push_back(static_cast<char>(distance >> 8));
+		if (match - 4 >= 15)
+			length(match - 4 - 15);
+
+		i += match;
+		anchor = i;
+	}
+	literal(anchor, size - anchor, 0);
+}
+
+inline DataParseResult DataCodec::decompress(const uint8_t* bytes, size_t size, uint8_t* data, size_t dataSize)
+{
+	size_t in = 0;
+	size_t out = 0;
+	auto length = [&](size_t& n)
+	{
+		while (true)
+		{
+			if (in == size)
+				return false;
+			uint8_t b = bytes[in++];
+			n += b;
+			if (b != 255)
+				return true;
+		}
+	};
+
+	while (true)
+	{
+		if (in == size)
+			return DataParseResult(DataError::INVALID_VALUE, in);
+		uint8_t token = bytes[in++];
+
+		size_t n = token >> 4;
+		if (n == 15 && !length(n))
+			return DataParseResult(DataError::INVALID_VALUE, in);
+		if (n > size - in || n > dataSize - out)
+			return DataParseResult(DataError::INVALID_VALUE, in);
+		memcpy(data + out, bytes + in, n);
+		in += n;
+		out += n;
+
+		// e̋؂ŏI
+		if (in == size)
+			break;
+
+		if (size - in < 2)
+			return DataParseResult(DataError::INVALID_VALUE, in);
+		size_t distance = bytes[in] | (static_cast<size_t>(bytes[in + 1]) << 8);
+		if (distance == 0 || distance > out)
+			return DataParseResult(DataError::INVALID_VALUE, in);
+		in += 2;
+
+		size_t match = (token & 0x0F) + 4;
+		if (match == 19 && !length(match))
+			return DataParseResult(DataError::INVALID_VALUE, in);
+		if (match > dataSize - out)
+			return DataParseResult(DataError::INVALID_VALUE, in);
+
+		// v̒Zꍇ́A΂̃oCgJԂ
+		uint8_t* o = data + out;
+		for (size_t j = 0; j < match; j += distance)
+			memcpy(o + j, o + j - distance, match - j < distance ? match - j : distance);
+		out += match;
+	}
+
+	if (out != dataSize)
+		return DataParseResult(DataError::INVALID_VALUE, in);
+	return DataParseResult();
+}
+
+template<typename U>
+inline uint64_t DataCodec::widen(U value)
+{
+	return static_cast<uint64_t>(static_cast<int64_t>(static_cast<std::make_signed_t<U>>(value)));
+}
+
+inline uint64_t DataCodec::zigzag(uint64_t value)
+{
+	return (value << 1) ^ (0 - (value >> 63));
+}
+
+inline uint64_t DataCodec::unzigzag(uint64_t value)
+{
+	return (value >> 1) ^ (0 - (value & 1));
+}
+
+inline size_t DataCodec::varintSize(uint64_t value)
+{
+	size_t n = 1;
+	while (value >= 0x80)
+	{
+		value >>= 7;
+		++n;
+	}
+	return n;
+}
+
+inline void DataCodec::putVarint(uint64_t value, std::string& bytes)
+{
+	while (value >= 0x80)
+	{
+		bytes.push_back(static_cast<char>(value | 0x80));
+		value >>= 7;
+	}
+	bytes.push_back(static_cast<char>(value));
+}
+
+inline void DataCodec::put64(uint64_t value, std::string& bytes)
+{
+	for (int i = 0; i < 64; i += 8)
+		bytes.push_back(static_cast<char>(value >> i));
+}
+
+inline uint64_t DataCodec::load64(const uint8_t* p)
+{
+	// oCg̓gGfBAŏ
+	uint64_t v = 0;
+	for (int i = 0; i < 8; ++i)
+		v |= static_cast<uint64_t>(p[i]) << (i * 8);
+	return v;
+}
+
+inline int DataCodec::width(uint64_t value)
+{
+	int w = 0;
+	while (value != 0)
+	{
+		value >>= 1;
+		++w;
+	}
+	return w;
+}
+
+inline int DataCodec::packedWidth(uint64_t range)
+{
+	// 0rbgƗvfl߂oCg猈܂炸A̗vfm߂Ȃ̂ōŒ1rbgɂ
+	int w = width(range);
+	return w == 0 ? 1 : w;
+}
@@ -0,0 +1,271 @@
+#pragma once
+
+#include "DataSimd.h"
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+/// <summary>
+/// <para>DataItem::convertTo()ŕϊ̌^͈̔͊O̒l@</para>
+/// <para>SATURATE=͈͓Ɋۂ߂ (NaN0, ւ̕ϊŔ͈͊O̒ĺ}, boolւ̕ϊ0ȊOtrue)</para>
+/// <para>CHECKED=͈͊O̒l1łΕϊȂ (boolւ̕ϊ01͈͓Ƃ)</para>
+/// <para>ǂ琮ւ̕ϊ0̕ɐ؂̂āAւ̕ϊ͍ł߂lɊۂ߂</para>
+/// </summary>
+enum class DataConvertMode
+{
+	SATURATE,
+	CHECKED
+};
+
+/// <summary>
+/// <para>z̗vf̌^ϊ֐Q</para>
+/// <para>ϊ̌^̃TCYϊȉ̏ꍇAz̏ŕϊĂ悢</para>
+/// <para>E32rbgȉ̐doubleEfloatւ̕ϊdoublefloatEint32_tւ̕ϊSIMD߂g</para>
+/// </summary>
+class DataConverter
+{
+public:
+	/// <returns>true=SĂ̗vfϊ̌^͈͓̔</returns>
+	template<typename From, typename To>
+	static bool inRange(const From* data, size_t count);
+
+	/// <summary>
+	/// <para>vf1ϊ̌^ɕϊ</para>
+	/// <para>͈͊O̒lSATURATE̋KŊۂ߂</para>
+	/// </summary>
+	/// <param name="source">ϊ̔z</param>
+	/// <param name="destination">ϊ̔z (sourceƓAhXł悢)</param>
+	/// <param name="count">vf</param>
+	template<typename From, typename To>
+	static void convert(const From* source, To* destination, size_t count);
+
+	/// <returns>1̒lSATURATE̋Kŕϊl</returns>
+	template<typename From, typename To>
+	static To saturate(From value);
+
+	/// <returns>true=lϊ̌^͈͓̔</returns>
+	template<typename From, typename To>
+	static bool inRange(From value);
+
+private:
+	/// <returns>pǂ񂾒l (^̕ʖKɐGȂ悤memcpyœǂ)</returns>
+	template<typename T>
+	static T load(const void* p);
+};
+
+
+
+
+template<typename From, typename To>
+inline bool DataConverter::inRange(const From* data, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (!inRange<From, To>(data[i]))
+			return false;
+	}
+	return true;
+}
+
+template<typename From, typename To>
+inline void DataConverter::convert(const From* source, To* destination, size_t count)
+{
+	static_assert(std::is_arithmetic_v<From> && std::is_arithmetic_v<To>, "l^̂");
+
+	size_t i = 0;
+#if defined(FDA_SIMD_AVX2)
+	// z̏ŕϊꍇAǂݍ񂾔͈͂Oɂ܂Ȃ
+	if constexpr (std::is_same_v<To, double> && (std::is_same_v<From, float> || (std::is_integral_v<From> && !std::is_same_v<From, bool> && sizeof(From) <= 4 && !(std::is_unsigned_v<From> && sizeof(From) == 4))))
+	{
+		for (; i + 4 <= count; i += 4)
+		{
+			__m256d v;
+			if constexpr (std::is_same_v<From, float>)
+				v = _mm256_cvtps_pd(_mm_loadu_ps(source + i));
+			else if constexpr (sizeof(From) == 4)
+				v = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i)));
+			else if constexpr (sizeof(From) == 2)
+			{
+				__m128i w = _mm_cvtsi64_si128(load<int64_t>(source + i));
+				v = _mm256_cvtepi32_pd(std::is_signed_v<From> ? _mm_cvtepi16_epi32(w) : _mm_cvtepu16_epi32(w));
+			}
+			else
+			{
+				__m128i w = _mm_cvtsi32_si128(load<int32_t>(source + i));
+				v = _mm256_cvtepi32_pd(std::is_signed_v<From> ? _mm_cvtepi8_epi32(w) : _mm_cvtepu8_epi32(w));
+			}
+			_mm256_storeu_pd(destination + i, v);
+		}
+	}
+	else if constexpr (std::is_same_v<To, float> && std::is_integral_v<From> && !std::is_same_v<From, bool> && sizeof(From) <= 4 && !(std::is_unsigned_v<From> && sizeof(From) == 4))
+	{
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i v;
+			if constexpr (sizeof(From) == 4)
+				v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+			else if constexpr (sizeof(From) == 2)
+			{
+				__m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+				v = std::is_signed_v<From> ? _mm256_cvtepi16_epi32(w) : _mm256_cvtepu16_epi32(w);
+			}
+			else
+			{
+				__m128i w = _mm_cvtsi64_si128(load<int64_t>(source + i));
+				v = std::is_signed_v<From> ? _mm256_cvtepi8_epi32(w) : _mm256_cvtepu8_epi32(w);
+			}
+			_mm256_storeu_ps(destination + i, _mm256_cvtepi32_ps(v));
+		}
+	}
+	else if constexpr (std::is_same_v<From, double> && std::is_same_v<To, float>)
+	{
+		// ͈͊O̒lIEEE̋KŁ}ɂȂ
+		for (; i + 4 <= count; i += 4)
+			_mm_storeu_ps(destination + i, _mm256_cvtpd_ps(_mm256_loadu_pd(source + i)));
+	}
+	else if constexpr (std::is_same_v<From, double> && std::is_same_v<To, int32_t>)
+	{
+		// NaN0ɂĂ͈͓Ɋۂ߁A0̕ɐ؂̂Ă
+		const __m256d lo = _mm256_set1_pd(-2147483648.0);
+		const __m256d hi = _mm256_set1_pd(2147483647.0);
+		for (; i + 4 <= count; i += 4)
+		{
+			__m256d v = _mm256_loadu_pd(source + i);
+			v = _mm256_and_pd(v, _mm256_cmp_pd(v, v, _CMP_ORD_Q));
+			v = _mm256_min_pd(_mm256_max_pd(v, lo), hi);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm256_cvttpd_epi32(v));
+		}
+	}
+#elif defined(FDA_SIMD_SSE2)
+	if constexpr (std::is_same_v<From, float> && std::is_same_v<To, double>)
+	{
+		for (; i + 2 <= count; i += 2)
+			_mm_storeu_pd(destination + i, _mm_cvtps_pd(_mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(source + i)))));
+	}
+	else if constexpr (std::is_same_v<From, int32_t> && std::is_same_v<To, double>)
+	{
+		for (; i + 2 <= count; i += 2)
+			_mm_storeu_pd(destination + i, _mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(source + i))));
+	}
+	else if constexpr (std::is_same_v<From, int32_t> && std::is_same_v<To, float>)
+	{
+		for (; i + 4 <= count; i += 4)
+			_mm_storeu_ps(destination + i, _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i))));
+	}
+	else if constexpr (std::is_same_v<From, double> && std::is_same_v<To, float>)
+	{
+		for (; i + 2 <= count; i += 2)
+			_mm_storel_pi(reinterpret_cast<__m64*>(destination + i), _mm_cvtpd_ps(_mm_loadu_pd(source + i)));
+	}
+#endif
+
+	// SIMD߂ňȂgݍ킹ƒ[
+	// z̏ŕϊꍇ͕ʂ̌^œǂݏ̂ŁAmemcpyœǂݏČ^̕ʖKɐGȂ悤ɂ
+	for (; i < count; ++i)
+	{
+		To v = saturate<From, To>(load<From>(source + i));
+		memcpy(destination + i, &v, sizeof(To));
+	}
+}
+
+template<typename From, typename To>
+inline To DataConverter::saturate(From value)
+{
+	using ToLimits = std::numeric_limits<To>;
+
+	if constexpr (std::is_same_v<To, bool>)
+	{
+		return value != 0;
+	}
+	else if constexpr (std::is_same_v<From, bool>)
+	{
+		return static_cast<To>(value ? 1 : 0);
+	}
+	else if constexpr (std::is_floating_point_v<To>)
+	{
+		if constexpr (std::is_floating_point_v<From> && sizeof(From) > sizeof(To))
+		{
+			if (value > (ToLimits::max)())
+				return ToLimits::infinity();
+			if (value < ToLimits::lowest())
+				return -ToLimits::infinity();
+		}
+		return static_cast<To>(value);
+	}
+	else if constexpr (std::is_floating_point_v<From>)
+	{
+		// ̍ől͎ŕ\ȂƂ̂ŁAől+1 (2ׂ̂) Ɣׂ
+		if (value != value)
+			return 0;
+		if (value <= static_cast<From>(ToLimits::lowest()))
+			return ToLimits::lowest();
+		if (value >= static_cast<From>((ToLimits::max)()) + static_cast<From>(1))
+			return (ToLimits::max)();
+		return static_cast<To>(value);
+	}
+	else if constexpr (std::is_signed_v<From> == std::is_signed_v<To>)
+	{
+		if constexpr (sizeof(From) > sizeof(To))
+		{
+			if (value < static_cast<From>(ToLimits::lowest()))
+				return ToLimits::lowest();
+			if (value > static_cast<From>((ToLimits::max)()))
+				return (ToLimits::max)();
+		}
+		return static_cast<To>(value);
+	}
+	else if constexpr (std::is_signed_v<From>)
+	{
+		// t畄
+		if (value < 0)
+			return 0;
+		if (static_cast<std::make_unsigned_t<From>>(value) > (ToLimits::max)())
+			return (ToLimits::max)();
+		return static_cast<To>(value);
+	}
+	else
+	{
+		// 畄t
+		if (value > static_cast<std::make_unsigned_t<To>>((ToLimits::max)()))
+			return (ToLimits::max)();
+		return static_cast<To>(value);
+	}
+}
+
+template<typename From, typename To>
+inline bool DataConverter::inRange(From value)
+{
+	if constexpr (std::is_same_v<To, bool>)
+		return value == 0 || value == 1;
+	else if constexpr (std::is_same_v<From, bool>)
+		return true;
+	else if constexpr (std::is_floating_point_v<To>)
+	{
+		if constexpr (std::is_floating_point_v<From> && sizeof(From) > sizeof(To))
+			return value != value || (value >= std::numeric_limits<To>::lowest() && value <= (std::numeric_limits<To>::max)())
+				|| value == std::numeric_limits<From>::infinity() || value == -std::numeric_limits<From>::infinity();
+		return true;
+	}
+	else if constexpr (std::is_floating_point_v<From>)
+	{
+		// ؂̂Ăʂ͈͓Ȃ悢
+		From lowest = static_cast<From>(std::numeric_limits<To>::lowest());
+		return value == value
+			&& (value >= lowest || value > lowest - static_cast<From>(1))
+			&& value < static_cast<From>((std::numeric_limits<To>::max)()) + static_cast<From>(1);
+	}
+	else
+	{
+		// ۂ߂l߂Č̒lɓΔ͈͓
+		return static_cast<From>(saturate<From, To>(value)) == value;
+	}
+}
+
+template<typename T>
+inline T DataConverter::load(const void* p)
+{
+	T v;
+	memcpy(&v, p, sizeof(T));
+	return v;
+}
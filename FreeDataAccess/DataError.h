@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+
+/// <summary>
+/// <para>O𓊂Ȃ͊֐ԂG[̎</para>
+/// <para>NONE=</para>
+/// <para>INVALID_VALUE=DataItem̒l̏ԈĂ</para>
+/// <para>UNSUPPORTED_SIZE=16ǐ^̃TCY1,2,4,8ɑΉȂ</para>
+/// <para>UNTERMINATED=^OEľ̉sȂ</para>
+/// <para>UNCLOSED_BOX=[DataBoxName]ɑΉ[/DataBoxName]Ȃ</para>
+/// </summary>
+enum class DataError
+{
+	NONE,
+	INVALID_VALUE,
+	UNSUPPORTED_SIZE,
+	UNTERMINATED,
+	UNCLOSED_BOX
+};
+
+/// <summary>
+/// <para>͂̌</para>
+/// <para>position͎sӏ́A͂̐擪̃oCg</para>
+/// </summary>
+struct DataParseResult
+{
+	DataError error;
+	size_t position;
+
+	DataParseResult() : error(DataError::NONE), position() {}
+	DataParseResult(DataError error, size_t position) : error(error), position(position) {}
+
+	/// <returns>true=</returns>
+	explicit operator bool() const { return error == DataError::NONE; }
+
+	/// <returns>G[̎ނ\</returns>
+	const char* message() const
+	{
+		switch (error)
+		{
+		case DataError::NONE: return "no error";
+		case DataError::INVALID_VALUE: return "invalid value";
+		case DataError::UNSUPPORTED_SIZE: return "unsupported element size";
+		case DataError::UNTERMINATED: return "unterminated tag or value";
+		case DataError::UNCLOSED_BOX: return "box is not closed";
+		}
+		return "unknown error";
+	}
+};
@@ -7,13 +7,19 @@
 /// <para>REAL=</para>
 /// <para>BOOL=^Ul</para>
 /// <para>TEXT=</para>
+/// <para>BLOB=base64 (ẑ, #b64:^̃TCY:base64̕ ƂőSĂ̗vf̃oCg܂Ƃ߂ĕ\)</para>
+/// <para>BITS=boolz1vf1rbgɋl߂ (#bits:vf:16i Ƃ8vf1oCgƂĕ\)</para>
+/// <para>PACKED=EϒErbgl߂Ȃǂŏk߂ (ẑ, #pk:^̃TCY:vf:lߕ:base64̕ Ƃ, lߕ͒l玩őI (DataCodec))</para>
 /// </summary>
 enum class DataFormat
 {
 	HEX,
 	REAL,
 	BOOL,
-	TEXT
+	TEXT,
+	BLOB,
+	BITS,
+	PACKED
 };
 
 /// <summary>
@@ -25,4 +31,16 @@ enum class DefaultDataFormat
 {
 	AUTO,
 	HEX
+};
+
+/// <summary>
+/// <para>DataBoxt@C֏o͂Ƃ̏</para>
+/// <para>INDENTED=q̐[Ƃ2A^O[/DataBoxName]</para>
+/// <para>MINIFIED=A^O͖OȂ[/]</para>
+/// <para>ǂ̏DataBox::inputFile()DataReaderȂǂœǂ߂</para>
+/// </summary>
+enum class DataOutputStyle
+{
+	INDENTED,
+	MINIFIED
 };
\ No newline at end of file
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+/// <summary>
+/// <para>DataItemDataBox̓ẽnbVlvZ֐Q</para>
+/// </summary>
+struct DataHash
+{
+	/// <returns>oCg̃nbVl</returns>
+	static uint64_t bytes(const void* data, size_t size, uint64_t seed = 0);
+
+	/// <returns>hvaluenbVl</returns>
+	static uint64_t combine(uint64_t h, uint64_t value);
+
+	/// <returns>64bitl悭l</returns>
+	static uint64_t mix(uint64_t x);
+};
+
+/// <summary>
+/// <para>DataHashNode::beforeChange()ɓnύX̎</para>
+/// <para>ITEM=DataItem̒lύX</para>
+/// <para>BOX=DataBoxɎqǉE폜</para>
+/// <para>SUBTREE=DataBox̒gqƓւEj</para>
+/// </summary>
+enum class DataChange
+{
+	ITEM,
+	BOX,
+	SUBTREE
+};
+
+/// <summary>
+/// <para>nbVl̃LbVƐeւ̃|C^AύXɑc̃LbV𖳌ɂNX</para>
+/// <para>DataItemDataBox̊NXƂĎdgݏdȂpӂĂ</para>
+/// <para>LbVLȗvf̎q͕KLbVLɂȂ悤ɕۂ̂</para>
+/// <para>ɂƂ͊ɖȑcɓB_Ŏ~߂</para>
+/// </summary>
+class DataHashNode
+{
+public:
+	/// <summary>
+	/// <para>gƑc̃nbVl̃LbV𖳌ɂ</para>
+	/// <para>LXgœ|C^oRŒlꍇ͂ĂԂ</para>
+	/// </summary>
+	void invalidateHash();
+
+	using ChangeHook = void (*)(DataHashNode* node, DataChange change) noexcept;
+
+	/// <summary>
+	/// <para>DataItemDataBoxύX钼OɌĂ΂֐ݒ肷</para>
+	/// <para>DataSnapshotύXȌԂۑ邽߂Ɏg</para>
+	/// <para>noexcept̃[uĂ΂̂ŁA֐͗O𓊂Ă͂ȂȂ</para>
+	/// </summary>
+	static void setChangeHook(ChangeHook hook);
+
+protected:
+	DataHashNode();
+
+	/// <summary>
+	/// <para>nbVlRs[Ae̓Rs[Ȃ</para>
+	/// </summary>
+	DataHashNode(const DataHashNode& rhs);
+
+	/// <summary>
+	/// <para>[ubeforeChange()ĂłAnbVlRs[</para>
+	/// <para>hNX̃[uRXgN^ŁAo[uOɕύXʒm邽߂Ɏg</para>
+	/// </summary>
+	DataHashNode(DataHashNode& rhs, DataChange change);
+
+	/// <summary>
+	/// <para>nbVlRs[Ae͕ύXɖɂ</para>
+	/// </summary>
+	DataHashNode& operator=(const DataHashNode& rhs);
+
+	~DataHashNode() = default;
+
+	/// <summary>
+	/// <para>ύX̒OɌĂ</para>
+	/// </summary>
+	void beforeChange(DataChange change);
+
+protected:
+	friend class DataBox;
+	friend class DataSnapshot;
+
+	DataHashNode* m_hashParent;
+	mutable uint64_t m_hash;
+	mutable bool m_hashCache;
+
+	static std::atomic<ChangeHook> ms_changeHook;
+};
+
+
+
+
+inline uint64_t DataHash::bytes(const void* data, size_t size, uint64_t seed)
+{
+	// 8oCg
+	const unsigned char* p = static_cast<const unsigned char*>(data);
+	uint64_t h = seed ^ mix(size + 0x9E3779B97F4A7C15ull);
+	while (size >= 8)
+	{
+		uint64_t v;
+		memcpy(&v, p, 8);
+		h = mix(h ^ v) + 0x9E3779B97F4A7C15ull;
+		p += 8;
+		size -= 8;
+	}
+	uint64_t v = 0;
+	if (size > 0)
+		memcpy(&v, p, size);
+	return mix(h ^ v);
+}
+
+inline uint64_t DataHash::combine(uint64_t h, uint64_t value)
+{
+	return mix(h ^ (value + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2)));
+}
+
+inline uint64_t DataHash::mix(uint64_t x)
+{
+	x ^= x >> 33;
+	x *= 0xFF51AFD7ED558CCDull;
+	x ^= x >> 33;
+	x *= 0xC4CEB9FE1A85EC53ull;
+	x ^= x >> 33;
+	return x;
+}
+
+inline std::atomic<DataHashNode::ChangeHook> DataHashNode::ms_changeHook = nullptr;
+
+inline void DataHashNode::invalidateHash()
+{
+	m_hashCache = false;
+	for (DataHashNode* n = m_hashParent; n && n->m_hashCache; n = n->m_hashParent)
+		n->m_hashCache = false;
+}
+
+inline void DataHashNode::setChangeHook(ChangeHook hook)
+{
+	ms_changeHook.store(hook, std::memory_order_release);
+}
+
+inline DataHashNode::DataHashNode()
+	: m_hashParent()
+	, m_hash()
+	, m_hashCache()
+{
+}
+
+inline DataHashNode::DataHashNode(const DataHashNode& rhs)
+	: m_hashParent()
+	, m_hash(rhs.m_hash)
+	, m_hashCache(rhs.m_hashCache)
+{
+}
+
+inline DataHashNode::DataHashNode(DataHashNode& rhs, DataChange change)
+	: m_hashParent()
+	, m_hash()
+	, m_hashCache()
+{
+	// NX͔̏hNX̃oȂ̂ŁA[u͂܂ύXĂȂ
+	rhs.beforeChange(change);
+	m_hash = rhs.m_hash;
+	m_hashCache = rhs.m_hashCache;
+}
+
+inline DataHashNode& DataHashNode::operator=(const DataHashNode& rhs)
+{
+	m_hash = rhs.m_hash;
+	m_hashCache = rhs.m_hashCache;
+	if (m_hashParent)
+		m_hashParent->invalidateHash();
+	return *this;
+}
+
+inline void DataHashNode::beforeChange(DataChange change)
+{
+	if (ChangeHook h = ms_changeHook.load(std::memory_order_acquire))
+		h(this, change);
+}
@@ -0,0 +1,317 @@
+#pragma once
+
+#include "DataBox.h"
+#include <map>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <variant>
+
+/// <summary>
+/// <para>DataIndexlr@</para>
+/// <para>VALUE=^ɉl (E^UlE͕Ȃint64_tE0ȏȂuint64_t, double, Ɣzstd::string)</para>
+/// <para>FORMAT=DataItem::operator()()̕</para>
+/// </summary>
+enum class DataIndexMode
+{
+	VALUE,
+	FORMAT
+};
+
+/// <summary>
+/// <para>DataBoxȉ̑SĂDataItemɂāAlpX</para>
+/// <para>̑ODataBox̃nbVlrAύXꂽDataBoxDataItemɔf</para>
+/// <para>add()EEoperator&lt;&lt;Ȃǂł̕ύX͑SĎ̌ɔf</para>
+/// <para>pX'/'؂</para>
+/// <para>DataItem͕̗LȂ̂ŁAŏʃrbgĂ鐮͕̒lƕt̒̕l̗œo^</para>
+/// <para>̂߁A̒lƑ傫ȕ̒l܂range()ł͓DataItem2񌻂</para>
+/// <para>DataIndexɑΏۂDataBoxjȂ</para>
+/// </summary>
+class DataIndex
+{
+public:
+	using Key = std::variant<int64_t, uint64_t, double, std::string>;
+	using Map = std::multimap<Key, std::string>;
+	using Range = DataBox::Range<Map::const_iterator>;
+
+public:
+	/// <summary>
+	/// <para>쐬</para>
+	/// </summary>
+	/// <param name="box">ΏۂDataBox</param>
+	/// <param name="mode">lr@</param>
+	explicit DataIndex(const DataBox& box, DataIndexMode mode = DataIndexMode::VALUE);
+
+	DataIndex(const DataIndex&) = delete;
+	DataIndex& operator=(const DataIndex&) = delete;
+
+public:
+	/// <summary>
+	/// <para>lvalueɓDataItem</para>
+	/// </summary>
+	/// <returns>(l, pX)̃yA͈̔</returns>
+	template<typename T>
+	Range find(const T& value);
+
+	/// <summary>
+	/// <para>lfirstȏlastDataItem</para>
+	/// <para>VALUȄꍇAEE̊Ԃł͐&lt;&lt;̏ɂȂ</para>
+	/// <para>lastfirstȉ̏ꍇ͈͋̔</para>
+	/// </summary>
+	/// <returns>(l, pX)̃yA͈̔</returns>
+	template<typename T>
+	Range range(const T& first, const T& last);
+
+	/// <summary>
+	/// <para>DataBox̕ύXɔf</para>
+	/// <para>find()range()͎ŌĂ</para>
+	/// </summary>
+	void refresh();
+
+	/// <returns>ɓo^ĂDataItem̐</returns>
+	size_t size() const;
+
+	/// <returns>DataItem̒l̃L[ɂ (͕ƂĈ)</returns>
+	static Key key(const DataItem& item, DataIndexMode mode);
+
+	/// <returns>l̃L[ɂ</returns>
+	template<typename T>
+	static Key key(const T& value);
+
+private:
+	struct Node;
+
+	struct ItemState
+	{
+		uint64_t hash;
+		Map::iterator entry;
+		Map::iterator negative;
+	};
+
+	struct Node
+	{
+		uint64_t hash;
+		bool valid;
+		std::map<std::string, ItemState, std::less<>> items;
+		std::map<std::string, Node, std::less<>> boxes;
+	};
+
+	void refresh(Node& node, const DataBox& box, const std::string& path);
+	void erase(Node& node);
+
+	/// <summary>
+	/// <para>DataItemɓo^</para>
+	/// </summary>
+	ItemState insert(const DataItem& item, const std::string& path);
+
+	/// <summary>
+	/// <para>insert()œo^̂菜</para>
+	/// </summary>
+	void erase(const ItemState& state);
+
+	/// <returns>ŏʃrbgĂ鐮𕄍tƂ݂Ȃ̒l, std::nullopt=ȊO</returns>
+	static std::optional<int64_t> negative(const DataItem& item, DataIndexMode mode);
+
+private:
+	const DataBox& m_box;
+	DataIndexMode m_mode;
+	Map m_map;
+	Node m_root;
+	size_t m_size;
+};
+
+
+
+
+inline DataIndex::DataIndex(const DataBox& box, DataIndexMode mode)
+	: m_box(box)
+	, m_mode(mode)
+	, m_map()
+	, m_root()
+	, m_size()
+{
+	refresh();
+}
+
+template<typename T>
+inline DataIndex::Range DataIndex::find(const T& value)
+{
+	refresh();
+	auto r = m_map.equal_range(key(value));
+	return Range(r.first, r.second);
+}
+
+template<typename T>
+inline DataIndex::Range DataIndex::range(const T& first, const T& last)
+{
+	refresh();
+	Key f = key(first);
+	Key l = key(last);
+	auto i = m_map.lower_bound(f);
+	return Range(i, l <= f ? i : m_map.lower_bound(l));
+}
+
+inline void DataIndex::refresh()
+{
+	refresh(m_root, m_box, std::string());
+}
+
+inline size_t DataIndex::size() const
+{
+	return m_size;
+}
+
+inline DataIndex::Key DataIndex::key(const DataItem& item, DataIndexMode mode)
+{
+	if (mode == DataIndexMode::FORMAT)
+		return std::string(item());
+
+	const void* p = item.getElementPointer();
+	size_t c = item.getElementCount();
+	if (c == 0)
+	{
+		if (item.getFormat() == DataFormat::REAL)
+		{
+			if (item.getElementSize() == sizeof(float))
+				return static_cast<double>(*static_cast<const float*>(p));
+			return *static_cast<const double*>(p);
+		}
+
+		switch (item.getElementSize())
+		{
+		case 1: return static_cast<uint64_t>(*static_cast<const uint8_t*>(p));
+		case 2: return static_cast<uint64_t>(*static_cast<const uint16_t*>(p));
+		case 4: return static_cast<uint64_t>(*static_cast<const uint32_t*>(p));
+		default: return *static_cast<const uint64_t*>(p);
+		}
+	}
+
+	// kI[͒gŁAȊO̔z͏Ŕr
+	const char* text = static_cast<const char*>(p);
+	if (item.getElementSize() == sizeof(char) && text[c - 1] == '\0')
+		return std::string(text, c - 1);
+	return std::string(item());
+}
+
+template<typename T>
+inline DataIndex::Key DataIndex::key(const T& value)
+{
+	if constexpr (std::is_same_v<T, bool>)
+		return static_cast<uint64_t>(value ? 1 : 0);
+	else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+	{
+		// ̒l͕tŁA0ȏ̒l͕̐ƓL[ɂ
+		if (value < 0)
+			return static_cast<int64_t>(value);
+		return static_cast<uint64_t>(value);
+	}
+	else if constexpr (std::is_integral_v<T>)
+		return static_cast<uint64_t>(value);
+	else if constexpr (std::is_floating_point_v<T>)
+		return static_cast<double>(value);
+	else
+		return std::string(value);
+}
+
+inline void DataIndex::refresh(Node& node, const DataBox& box, const std::string& path)
+{
+	// nbVlςĂȂΒgHȂ
+	if (node.valid && node.hash == box.hash())
+		return;
+
+	// DataItem𖼑OɓɑAǉE폜EύXꂽ̂XV
+	auto i = node.items.begin();
+	for (auto& j : box.items())
+	{
+		while (i != node.items.end() && i->first < j.first)
+		{
+			erase(i->second);
+			i = node.items.erase(i);
+		}
+		if (i != node.items.end() && i->first == j.first)
+		{
+			if (i->second.hash != j.second.hash())
+			{
+				erase(i->second);
+				i->second = insert(j.second, path + j.first);
+			}
+			++i;
+		}
+		else
+		{
+			i = ++node.items.emplace_hint(i, j.first, insert(j.second, path + j.first));
+		}
+	}
+	while (i != node.items.end())
+	{
+		erase(i->second);
+		i = node.items.erase(i);
+	}
+
+	// DataBoxlɑAċAIɍXV
+	auto b = node.boxes.begin();
+	for (auto& j : box.boxes())
+	{
+		while (b != node.boxes.end() && b->first < j.first)
+		{
+			erase(b->second);
+			b = node.boxes.erase(b);
+		}
+		if (b == node.boxes.end() || b->first != j.first)
+			b = node.boxes.emplace_hint(b, j.first, Node());
+		refresh(b->second, j.second, path + j.first + '/');
+		++b;
+	}
+	while (b != node.boxes.end())
+	{
+		erase(b->second);
+		b = node.boxes.erase(b);
+	}
+
+	node.hash = box.hash();
+	node.valid = true;
+}
+
+inline void DataIndex::erase(Node& node)
+{
+	for (auto& i : node.items)
+		erase(i.second);
+	for (auto& i : node.boxes)
+		erase(i.second);
+}
+
+inline DataIndex::ItemState DataIndex::insert(const DataItem& item, const std::string& path)
+{
+	ItemState s = {item.hash(), m_map.emplace(key(item, m_mode), path), m_map.end()};
+	if (std::optional<int64_t> n = negative(item, m_mode))
+		s.negative = m_map.emplace(*n, path);
+	++m_size;
+	return s;
+}
+
+inline void DataIndex::erase(const ItemState& state)
+{
+	m_map.erase(state.entry);
+	if (state.negative != m_map.end())
+		m_map.erase(state.negative);
+	--m_size;
+}
+
+inline std::optional<int64_t> DataIndex::negative(const DataItem& item, DataIndexMode mode)
+{
+	if (mode == DataIndexMode::FORMAT || item.getElementCount() != 0 || item.getFormat() == DataFormat::REAL)
+		return std::nullopt;
+
+	const void* p = item.getElementPointer();
+	int64_t v;
+	switch (item.getElementSize())
+	{
+	case 1: v = *static_cast<const int8_t*>(p); break;
+	case 2: v = *static_cast<const int16_t*>(p); break;
+	case 4: v = *static_cast<const int32_t*>(p); break;
+	default: v = *static_cast<const int64_t*>(p); break;
+	}
+	if (v >= 0)
+		return std::nullopt;
+	return v;
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include "DataFormat.h"
+#include "DataTrace.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string>
+#include <unordered_map>
+
+/// <summary>
+/// <para>lDataItem̊ԂŒlƏL邽߂̃v[</para>
+/// <para>DataItem::intern()DataBox::intern()œo^ƁA^̃TCYEvfE^CvElDataItem1̗̈QƂ</para>
+/// <para>LĂl͎QƐŊǗAŌɎQƂĂDataItemƂɃv[菜</para>
+/// <para>LĂDataItemύXƁAύXOɎg̒lRs[ċL߂ (Rs[ICg)</para>
+/// <para>v[ɔjĂ悢ALĂDataItem̑ƓɔjȂ</para>
+/// </summary>
+class DataInternPool
+{
+public:
+	DataInternPool();
+
+	/// <summary>
+	/// <para>܂QƂĂl̓v[؂藣AŌ̎QƂȂƂɉ</para>
+	/// </summary>
+	~DataInternPool();
+
+	DataInternPool(const DataInternPool&) = delete;
+	DataInternPool& operator=(const DataInternPool&) = delete;
+
+public:
+	/// <returns>o^Ăl̎ނ̐</returns>
+	size_t size() const;
+
+private:
+	friend class DataItem;
+
+	/// <summary>
+	/// <para>LĂl̊Ǘ</para>
+	/// <para>l̒OɒûŁAlւ̃|C^狁߂</para>
+	/// </summary>
+	struct Entry
+	{
+		DataInternPool* pool;
+		std::atomic<size_t> references;
+		uint64_t hash;
+		size_t elementSize;
+		size_t elementCount;
+		DataFormat format;
+		std::string text;
+	};
+
+	static const size_t HEADER_SIZE = (sizeof(Entry) + 7) / 8 * 8;
+
+	/// <summary>
+	/// <para>lo^Ă΂̎QƐ𑝂₵AȂΓo^</para>
+	/// <para>text͐Vo^ꍇɂg</para>
+	/// </summary>
+	/// <returns>LĂlւ̃|C^</returns>
+	void* acquire(size_t elementSize, size_t elementCount, DataFormat format, const void* elementPointer, uint64_t hash, std::string&& text);
+
+	/// <summary>
+	/// <para>ɎQƂĂl̎QƐ𑝂₷</para>
+	/// </summary>
+	static void share(void* elementPointer);
+
+	/// <summary>
+	/// <para>QƐ炵A[ɂȂ</para>
+	/// </summary>
+	static void release(void* elementPointer);
+
+	static Entry* entry(const void* elementPointer);
+	static size_t bytes(size_t elementSize, size_t elementCount);
+	static void destroy(Entry* e);
+
+private:
+	mutable std::mutex m_mutex;
+	std::unordered_multimap<uint64_t, Entry*> m_entries;
+};
+
+
+
+
+inline DataInternPool::DataInternPool()
+	: m_mutex()
+	, m_entries()
+{
+}
+
+inline DataInternPool::~DataInternPool()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (auto& i : m_entries)
+		i.second->pool = nullptr;
+}
+
+inline size_t DataInternPool::size() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_entries.size();
+}
+
+inline void* DataInternPool::acquire(size_t elementSize, size_t elementCount, DataFormat format, const void* elementPointer, uint64_t hash, std::string&& text)
+{
+	size_t n = bytes(elementSize, elementCount);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto range = m_entries.equal_range(hash);
+	for (auto i = range.first; i != range.second; ++i)
+	{
+		Entry* e = i->second;
+		char* p = reinterpret_cast<char*>(e) + HEADER_SIZE;
+		if (e->elementSize == elementSize && e->elementCount == elementCount && e->format == format && memcmp(p, elementPointer, n) == 0)
+		{
+			e->references.fetch_add(1, std::memory_order_relaxed);
+			return p;
+		}
+	}
+
+	// Ǘƒl܂Ƃ߂Ċmۂ (l8oCgEɑ悤uint64_t̔zɂ)
+	FDA_TRACE_COUNT(DataTraceCounter::PAYLOAD_ALLOCATION);
+	uint64_t* block = new uint64_t[(HEADER_SIZE + n + 7) / 8];
+	Entry* e = new (block) Entry{this, {1}, hash, elementSize, elementCount, format, std::move(text)};
+	char* p = reinterpret_cast<char*>(block) + HEADER_SIZE;
+	memcpy(p, elementPointer, n);
+	m_entries.emplace(hash, e);
+	return p;
+}
+
+inline void DataInternPool::share(void* elementPointer)
+{
+	entry(elementPointer)->references.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline void DataInternPool::release(void* elementPointer)
+{
+	Entry* e = entry(elementPointer);
+	DataInternPool* pool = e->pool;
+	if (pool == nullptr)
+	{
+		// v[ɔjꂽ
+		if (e->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			destroy(e);
+		return;
+	}
+
+	// QƐ[ɂȂlacquire()Ȃ悤A菜܂Ńv[bNĂ
+	std::lock_guard<std::mutex> lock(pool->m_mutex);
+	if (e->references.fetch_sub(1, std::memory_order_acq_rel) != 1)
+		return;
+
+	auto range = pool->m_entries.equal_range(e->hash);
+	for (auto i = range.first; i != range.second; ++i)
+	{
+		if (i->second == e)
+		{
+			pool->m_entries.erase(i);
+			break;
+		}
+	}
+	destroy(e);
+}
+
+inline DataInternPool::Entry* DataInternPool::entry(const void* elementPointer)
+{
+	return reinterpret_cast<Entry*>(reinterpret_cast<uintptr_t>(elementPointer) - HEADER_SIZE);
+}
+
+inline size_t DataInternPool::bytes(size_t elementSize, size_t elementCount)
+{
+	return elementSize * (elementCount == 0 ? 1 : elementCount);
+}
+
+inline void DataInternPool::destroy(Entry* e)
+{
+	e->~Entry();
+	delete[] reinterpret_cast<uint64_t*>(e);
+}
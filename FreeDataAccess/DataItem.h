@@ -1,9 +1,22 @@
 #pragma once
 
 #include "DataFormat.h"
+#include "DataTrace.h"
+#include "DataHash.h"
+#include "DataError.h"
+#include "DataConverter.h"
+#include "DataBase64.h"
+#include "DataCodec.h"
+#include "DataIntern.h"
+#include "DataBits.h"
+#include "DataMappedFile.h"
 #include <type_traits>
 #include <memory>
+#include <optional>
 #include <string>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
 
 /// <summary>
 /// <para>IɌ^ύX\(v~eBu^)ȕϐ\NX</para>
@@ -11,7 +24,7 @@
 /// <para>̃NXɂČ^̃TCYƂ̂̓|C^菜^̃TCY\</para>
 /// <para>char^̔zݒ肷Ƃ́AKkI[ł邱</para>
 /// </summary>
-class DataItem
+class DataItem : public DataHashNode
 {
 public:
 	/// <summary>
@@ -59,11 +72,15 @@ public:
 
 	/// <summary>
 	/// <para>DeepRs[</para>
+	/// <para>rhsDataInternPool̒lLĂꍇ͓lL</para>
+	/// <para>rhst@CɃ}bvlQƂĂꍇ̓ɃRs[</para>
 	/// </summary>
 	DataItem(const DataItem& rhs);
 
 	/// <summary>
 	/// <para>DeepRs[</para>
+	/// <para>rhsDataInternPool̒lLĂꍇ͓lL</para>
+	/// <para>rhst@CɃ}bvlQƂĂꍇ̓ɃRs[</para>
 	/// </summary>
 	DataItem& operator=(const DataItem& rhs);
 
@@ -79,10 +96,68 @@ public:
 	/// </summary>
 	static DataItem createFromFormat(const char* format);
 
+	/// <summary>
+	/// <para>DataItem̏Ԓl񂩂ȀԒlDataItem𐶐</para>
+	/// <para>ԈĂĂO𓊂AG[̎ނƈʒuԂ</para>
+	/// <para>sꍇitem͕ύXȂ</para>
+	/// </summary>
+	/// <param name="format">Ԓl</param>
+	/// <param name="item"></param>
+	static DataParseResult tryCreateFromFormat(const char* format, DataItem& item);
+
+	/// <summary>
+	/// <para>̒lDeepRs[DataItem𐶐</para>
+	/// <para>^̃TCY1,2,4,8ȊOƗO</para>
+	/// </summary>
+	/// <param name="elementSize">^̃TCY</param>
+	/// <param name="elementCount">0=złȂ, 1ȏ=z̗vf</param>
+	/// <param name="format">^Cv</param>
+	/// <param name="elementPointer">lւ̃|C^</param>
+	static DataItem createFromMemory(size_t elementSize, size_t elementCount, DataFormat format, const void* elementPointer);
+
+	/// <summary>
+	/// <para>SĂ̗vfvalueboolzA^CvBITS̋l߂ԂŐ</para>
+	/// </summary>
+	/// <param name="size">vf</param>
+	/// <param name="value">SĂ̗vf̒l</param>
+	static DataItem createBits(size_t size, bool value = false);
+
+	/// <summary>
+	/// <para>}bvt@C̔zRs[ɎQƂDataItem𐶐</para>
+	/// <para>l͐GꂽƂɃt@Cǂݍ܂̂ŁA傫z</para>
+	/// <para>fileCOPYWRITEŊJĂ邱ƁBWRITȄꍇAlƃt@Cɔf</para>
+	/// <para>file܂łɁADataItemj邩ʂ̒lŏ㏑邱</para>
+	/// <para>Rs[ƃt@CQƂAzŜ֓ǂݍŃRs[ (DataBoxƃRs[ꍇ)</para>
+	/// <para>hash()Eequals()E͔zŜɐĜŁAt@C̔zSēǂݍ</para>
+	/// <para>READŊJĂE͈͂t@C𒴂Eoffset^̃TCY̔{łȂꍇO</para>
+	/// </summary>
+	/// <param name="file">}bvt@C</param>
+	/// <param name="offset">z̐擪̃t@C̈ʒu</param>
+	/// <param name="elementSize">^̃TCY</param>
+	/// <param name="elementCount">z̗vf (1ȏ)</param>
+	/// <param name="format">^Cv</param>
+	static DataItem createFromMapping(DataMappedFile& file, size_t offset, size_t elementSize, size_t elementCount, DataFormat format);
+
 public:
 	/// <returns>g̏Ԓl</returns>
 	const char* operator()() const;
 
+	/// <summary>
+	/// <para>loperator()()ƓKŏtext̖ɒǉ</para>
+	/// <para>DataItem𐶐ɒlƂɎg</para>
+	/// <para>^Cv^ɔΉ̏ꍇO</para>
+	/// </summary>
+	/// <param name="text">ǉ̕</param>
+	/// <param name="format">^Cv</param>
+	/// <param name="elementSize">^̃TCY</param>
+	/// <param name="elementCount">0=złȂ, 1ȏ=z̗vf</param>
+	/// <param name="elementPointer">lւ̃|C^</param>
+	static void appendFormat(std::string& text, DataFormat format, size_t elementSize, size_t elementCount, const void* elementPointer);
+
+	/// <returns>^Tɑ΂鏑^CṽftHgl</returns>
+	template<typename T>
+	static DataFormat getDefaultFormat();
+
 	/// <summary>
 	/// <para>LXg邱ƂŕێĂlm邱Ƃł</para>
 	/// <para>ݒ肵^ƈقȂTCY̌^ɃLXg悤ƂƗO</para>
@@ -104,6 +179,20 @@ public:
 	template<typename T>
 	void operator=(T element);
 
+	/// <summary>
+	/// <para>LXgƓێĂlo</para>
+	/// <para>ݒ肵^ƈقȂTCY̌^̏ꍇAO𓊂std::nulloptԂ</para>
+	/// </summary>
+	template<typename T>
+	std::optional<T> tryAs() const;
+
+	/// <summary>
+	/// <para>|C^ւ̃LXgƓli[Ă郁QƂ</para>
+	/// <para>ݒ肵^ƈقȂTCY̌^̏ꍇAO𓊂nullptrԂ</para>
+	/// </summary>
+	template<typename T>
+	T* tryPointer() const;
+
 	/// <summary>
 	/// <para>ێĂl^񂲂Ə㏑</para>
 	/// <para>^Cv̓ftHglɕύX</para>
@@ -132,6 +221,27 @@ public:
 	template<typename T>
 	void deep(const T* elementPointer, size_t elementCount);
 
+	/// <summary>
+	/// <para>ľ^ϊ (z̏ꍇ͑SĂ̗vfϊ)</para>
+	/// <para>ϊ̌^͏^Cvƌ^̃TCYŌ߂ (HEX=, REAL=floatdouble, BOOL=bool, TEXT=char)</para>
+	/// <para>^̃TCYƏ^Cv(ftHgl)T̂̂ɂȂAvf͕ςȂ</para>
+	/// <para>T̃TCYϊȉ̏ꍇAmۍς݂̃̏ŕϊ</para>
+	/// </summary>
+	/// <param name="mode">ϊ̌^͈̔͊O̒l@</param>
+	/// <returns>true=ϊ, false=CHECKEDŔ͈͊O̒l (ύXȂ)</returns>
+	template<typename T>
+	bool convertTo(DataConvertMode mode = DataConvertMode::SATURATE);
+
+	/// <summary>
+	/// <para>ϊ̌^FromƂĒľ^ϊ</para>
+	/// <para>tƂĕϊꍇȂǂɎg</para>
+	/// <para>ݒ肵^From̃TCYقȂƗO</para>
+	/// </summary>
+	/// <param name="mode">ϊ̌^͈̔͊O̒l@</param>
+	/// <returns>true=ϊ, false=CHECKEDŔ͈͊O̒l (ύXȂ)</returns>
+	template<typename T, typename From>
+	bool convertTo(DataConvertMode mode = DataConvertMode::SATURATE);
+
 	/// <returns>ݒ肳Ă^̃TCY</returns>
 	size_t getElementSize() const;
 
@@ -141,21 +251,97 @@ public:
 	/// </returns>
 	size_t getElementCount() const;
 
+	/// <summary>
+	/// <para>^킸ɒli[Ă郁QƂ</para>
+	/// <para>^̊mF̓[U[s</para>
+	/// </summary>
+	/// <returns>li[Ă郁ւ̃|C^</returns>
+	const void* getElementPointer() const;
+
 	/// <returns>g̏Ԓl̏^Cv</returns>
 	DataFormat getFormat() const;
 
+	/// <returns>^̃TCYEvfE^CvElvZnbVl</returns>
+	uint64_t hash() const;
+
+	/// <summary>
+	/// <para>^̃TCYEvfE^CvElǂr</para>
+	/// <para>ǂDataInternPool̒lLĂꍇ̓AhXr</para>
+	/// </summary>
+	/// <returns>true=</returns>
+	bool equals(const DataItem& rhs) const;
+
+	/// <summary>
+	/// <para>lƏDataInternPoolɓo^AlDataItemƋL</para>
+	/// <para>lύX֐ĂԂƁAύXOɒlRs[ċL߂</para>
+	/// <para>LĂԂ́A|C^ւ̃LXgȂǂœ|C^ʂĒlȂ</para>
+	/// <para>t@CɃ}bvl͓o^Ȃ</para>
+	/// </summary>
+	/// <param name="pool">o^̃v[</param>
+	void intern(DataInternPool& pool);
+
+	/// <returns>true=DataInternPool̒lLĂ</returns>
+	bool interned() const;
+
+	/// <returns>true=t@CɃ}bvlQƂĂ (Rs[hash()͔zŜǂݍ)</returns>
+	bool mapped() const;
+
+	/// <summary>
+	/// <para>t@CɃ}bvz[first, first+count)̗vfOēǂݍނ悤OSɗv</para>
+	/// <para>t@CɃ}bvĂȂꍇ͉Ȃ</para>
+	/// </summary>
+	void prefetch(size_t first, size_t count) const;
+
+	/// <summary>
+	/// <para>t@CɃ}bvl̕ύXt@CɏoAI܂ő҂</para>
+	/// <para>t@CɃ}bvĂȂꍇ͉Ȃ</para>
+	/// </summary>
+	/// <returns>true=, false=s</returns>
+	bool flush() const;
+
+	/// <summary>
+	/// <para>t@CɃ}bvz[first, first+count)̗vfڂĂy[WA풓郁炷</para>
+	/// <para>vf͎ɐGꂽƂɓǂݍݒBCOPYŊJt@C̏ꍇAl͎</para>
+	/// <para>t@CɃ}bvĂȂꍇ͉Ȃ</para>
+	/// </summary>
+	void evict(size_t first, size_t count) const;
+
+	/// <summary>
+	/// <para>^CvBITS̋l߂boolzǂݏ</para>
+	/// <para>BITS̏ꍇA^̃TCY8, vf͐擪̃rbg\[h܂ރ[hɂȂAboolւ̃|C^ɂ̓LXgłȂ</para>
+	/// <para>^CvBITSłȂƗO</para>
+	/// <para>擾ƂɕύX̂ƂĈ̂ŁAhash()operator()()Ă񂾂擾Ă珑邱</para>
+	/// </summary>
+	DataBits bits();
+
+	/// <summary>
+	/// <para>^CvBITS̋l߂boolzǂ</para>
+	/// <para>^CvBITSłȂƗO</para>
+	/// </summary>
+	DataConstBits bits() const;
+
 	/// <summary>
 	/// <para>g̏Ԓl̏^Cvݒ肷</para>
 	/// <para>ݒ肳Ă^ɔΉ̏^Cvݒ肷ƗO</para>
+	/// <para>bool̔zBITSݒ肷1vf1rbgɋl߁ABITS̔zBOOLݒ肷1vf1oCgɖ߂</para>
 	/// </summary>
 	/// <param name="format">^Cv</param>
 	void setFormat(DataFormat format);
 
 private:
+	static DataParseResult parseFormat(const char* format, DataItem& item);
 	void deleteData();
 
-	template<typename T>
-	DataFormat getDefaultFormat();
+	/// <summary>
+	/// <para>LĂlg̗̈ɃRs[ċL߂</para>
+	/// </summary>
+	void detach();
+
+	/// <summary>
+	/// <para>boolzBITS̋l߂z𑊌݂ɕϊ</para>
+	/// </summary>
+	void pack();
+	void unpack();
 
 private:
 	static DefaultDataFormat ms_defaultFormat;
@@ -168,6 +354,8 @@ private:
 	DataFormat m_format;
 	mutable std::string m_text;
 	mutable bool m_cache;
+	bool m_interned;
+	bool m_mapped;
 };
 
 
@@ -187,6 +375,8 @@ inline DataItem::DataItem()
 	, m_format()
 	, m_text()
 	, m_cache()
+	, m_interned()
+	, m_mapped()
 {}
 
 template<typename T>
@@ -197,8 +387,11 @@ inline DataItem::DataItem(T element)
 	, m_format(getDefaultFormat<T>())
 	, m_text()
 	, m_cache()
+	, m_interned()
+	, m_mapped()
 {
 	static_assert(!std::is_pointer_v<T> && !std::is_array_v<T>, "|C^Ez͖");
+	FDA_TRACE_COUNT(DataTraceCounter::PAYLOAD_ALLOCATION);
 	m_elementPointer = new T(element);
 }
 
@@ -210,9 +403,12 @@ inline DataItem::DataItem(T* elementPointer, size_t elementCount, bool deepCopy)
 	, m_format(getDefaultFormat<T>())
 	, m_text()
 	, m_cache()
+	, m_interned()
+	, m_mapped()
 {
 	if (deepCopy)
 	{
+		FDA_TRACE_COUNT(DataTraceCounter::PAYLOAD_ALLOCATION);
 		m_elementPointer = new T[elementCount];
 		memcpy(m_elementPointer, elementPointer, m_elementSize * elementCount);
 	}
@@ -230,7 +426,10 @@ inline DataItem::DataItem(const T* elementPointer, size_t elementCount)
 	, m_format(getDefaultFormat<T>())
 	, m_text()
 	, m_cache()
+	, m_interned()
+	, m_mapped()
 {
+	FDA_TRACE_COUNT(DataTraceCounter::PAYLOAD_ALLOCATION);
 	m_elementPointer = new T[elementCount];
 	memcpy(m_elementPointer, elementPointer, m_elementSize * elementCount);
 }
@@ -242,24 +441,38 @@ inline DataItem::DataItem(const char* text)
 	, m_format(getDefaultFormat<char>())
 	, m_text()
 	, m_cache()
+	, m_interned()
+	, m_mapped()
 {
 	size_t c = 0;
 	while (text[c] != '\0') ++c;
 	++c;
 
 	m_elementCount = c;
+	FDA_TRACE_COUNT(DataTraceCounter::PAYLOAD_ALLOCATION);
 	m_elementPointer = new char[c];
 	memcpy(m_elementPointer, text, m_elementSize * c);
 }
 
 inline DataItem::DataItem(const DataItem& rhs)
-	: m_elementSize(rhs.m_elementSize)
+	: DataHashNode(rhs)
+	, m_elementSize(rhs.m_elementSize)
 	, m_elementCount(rhs.m_elementCount)
 	, m_elementPointer()
 	, m_format(rhs.m_format)
 	, m_text(rhs.m_text)
 	, m_cache(rhs.m_cache)
+	, m_interned(rhs.m_interned)
+	, m_mapped()
 {
+	if (m_interned)
+	{
+		m_elementPointer = rhs.m_elementPointer;
+		DataInternPool::share(m_elementPointer);
+		return;
+	}
+
+	FDA_TRACE_COUNT(DataTraceCounter::PAYLOAD_ALLOCATION);
 	if (m_elementCount == 0)
 	{
 		switch (m_elementSize)
@@ -268,7 +481,7 @@ inline DataItem::DataItem(const DataItem& rhs)
 		case 2: m_elementPointer = new uint16_t(*static_cast<uint16_t*>(rhs.m_elementPointer)); break;
 		case 4: m_elementPointer = new uint32_t(*static_cast<uint32_t*>(rhs.m_elementPointer)); break;
 		case 8: m_elementPointer = new uint64_t(*static_cast<uint64_t*>(rhs.m_elementPointer)); break;
-		default: throw;
+		default: throw std::invalid_argument("DataItem: unsupported element size");
 		}
 	}
 	else
@@ -279,7 +492,7 @@ inline DataItem::DataItem(const DataItem& rhs)
 		case 2: m_elementPointer = new uint16_t[m_elementCount]; break;
 		case 4: m_elementPointer = new uint32_t[m_elementCount]; break;
 		case 8: m_elementPointer = new uint64_t[m_elementCount]; break;
-		default: throw;
+		default: throw std::invalid_argument("DataItem: unsupported element size");
 		}
 		memcpy(m_elementPointer, rhs.m_elementPointer, m_elementSize * m_elementCount);
 	}
@@ -287,14 +500,33 @@ inline DataItem::DataItem(const DataItem& rhs)
 
 inline DataItem& DataItem::operator=(const DataItem& rhs)
 {
+	// lRs[Ȃ悤Ag͉̑Ȃ
+	if (this == &rhs)
+		return *this;
+
+	beforeChange(DataChange::ITEM);
+
+	// gƓlLĂꍇɔāAOɎQƐ𑝂₷
+	bool interned = rhs.m_interned;
+	if (interned)
+		DataInternPool::share(rhs.m_elementPointer);
 	deleteData();
+	DataHashNode::operator=(rhs);
 
 	m_elementSize = rhs.m_elementSize;
 	m_elementCount = rhs.m_elementCount;
 	m_format = rhs.m_format;
 	m_text = rhs.m_text;
 	m_cache = rhs.m_cache;
+	m_interned = interned;
 
+	if (m_interned)
+	{
+		m_elementPointer = rhs.m_elementPointer;
+		return *this;
+	}
+
+	FDA_TRACE_COUNT(DataTraceCounter::PAYLOAD_ALLOCATION);
 	if (m_elementCount == 0)
 	{
 		switch (m_elementSize)
@@ -303,7 +535,7 @@ inline DataItem& DataItem::operator=(const DataItem& rhs)
 		case 2: m_elementPointer = new uint16_t(*static_cast<uint16_t*>(rhs.m_elementPointer)); break;
 		case 4: m_elementPointer = new uint32_t(*static_cast<uint32_t*>(rhs.m_elementPointer)); break;
 		case 8: m_elementPointer = new uint64_t(*static_cast<uint64_t*>(rhs.m_elementPointer)); break;
-		default: throw;
+		default: throw std::invalid_argument("DataItem: unsupported element size");
 		}
 	}
 	else
@@ -314,7 +546,7 @@ inline DataItem& DataItem::operator=(const DataItem& rhs)
 		case 2: m_elementPointer = new uint16_t[m_elementCount]; break;
 		case 4: m_elementPointer = new uint32_t[m_elementCount]; break;
 		case 8: m_elementPointer = new uint64_t[m_elementCount]; break;
-		default: throw;
+		default: throw std::invalid_argument("DataItem: unsupported element size");
 		}
 		memcpy(m_elementPointer, rhs.m_elementPointer, m_elementSize * m_elementCount);
 	}
@@ -323,19 +555,28 @@ inline DataItem& DataItem::operator=(const DataItem& rhs)
 }
 
 inline DataItem::DataItem(DataItem&& rhs) noexcept
-	: m_elementSize(rhs.m_elementSize)
+	: DataHashNode(rhs, DataChange::ITEM)
+	, m_elementSize(rhs.m_elementSize)
 	, m_elementCount(rhs.m_elementCount)
 	, m_elementPointer(rhs.m_elementPointer)
 	, m_format(rhs.m_format)
 	, m_text(std::move(rhs.m_text))
 	, m_cache(rhs.m_cache)
+	, m_interned(rhs.m_interned)
+	, m_mapped(rhs.m_mapped)
 {
 	rhs.m_elementPointer = nullptr;
+	rhs.m_interned = false;
+	rhs.m_mapped = false;
+	rhs.invalidateHash();
 }
 
 inline DataItem& DataItem::operator=(DataItem&& rhs) noexcept
 {
+	beforeChange(DataChange::ITEM);
+	rhs.beforeChange(DataChange::ITEM);
 	deleteData();
+	DataHashNode::operator=(rhs);
 
 	m_elementSize = rhs.m_elementSize;
 	m_elementCount = rhs.m_elementCount;
@@ -343,8 +584,13 @@ inline DataItem& DataItem::operator=(DataItem&& rhs) noexcept
 	m_format = rhs.m_format;
 	m_text = std::move(rhs.m_text);
 	m_cache = rhs.m_cache;
+	m_interned = rhs.m_interned;
+	m_mapped = rhs.m_mapped;
 
 	rhs.m_elementPointer = nullptr;
+	rhs.m_interned = false;
+	rhs.m_mapped = false;
+	rhs.invalidateHash();
 	return *this;
 }
 
@@ -356,6 +602,29 @@ inline DataItem::~DataItem()
 inline DataItem DataItem::createFromFormat(const char* format)
 {
 	DataItem item;
+	DataParseResult r = parseFormat(format, item);
+	if (!r)
+		throw std::invalid_argument(std::string("DataItem: ") + r.message() + " at " + std::to_string(r.position));
+
+	// ΂ǂ̕łK1mۂĂ̂ŁAlێꍇ
+	FDA_TRACE_COUNT(DataTraceCounter::PAYLOAD_ALLOCATION);
+	return item;
+}
+
+inline DataParseResult DataItem::tryCreateFromFormat(const char* format, DataItem& item)
+{
+	DataItem t;
+	DataParseResult r = parseFormat(format, t);
+	if (r)
+	{
+		FDA_TRACE_COUNT(DataTraceCounter::PAYLOAD_ALLOCATION);
+		item = std::move(t);
+	}
+	return r;
+}
+
+inline DataParseResult DataItem::parseFormat(const char* format, DataItem& item)
+{
 	item.m_text = format;
 	item.m_cache = true;
 
@@ -372,7 +641,7 @@ inline DataItem DataItem::createFromFormat(const char* format)
 			else if ('A' <= p[0] && p[0] <= 'F')
 				v += p[0] - 'A' + 10;
 			else
-				throw;
+				return DataParseResult(DataError::INVALID_VALUE, static_cast<size_t>(p - format));
 			++p;
 			++s;
 		}
@@ -383,10 +652,10 @@ inline DataItem DataItem::createFromFormat(const char* format)
 		case 2: item.m_elementPointer = new uint16_t(static_cast<uint16_t>(v)); break;
 		case 4: item.m_elementPointer = new uint32_t(static_cast<uint32_t>(v)); break;
 		case 8: item.m_elementPointer = new uint64_t(static_cast<uint64_t>(v)); break;
-		default: throw;
+		default: return DataParseResult(DataError::UNSUPPORTED_SIZE, 2);
 		}
 		item.m_elementSize = s;
-		return item;
+		return DataParseResult();
 	}
 
 	// HEX array
@@ -403,7 +672,7 @@ inline DataItem DataItem::createFromFormat(const char* format)
 				else if (p[0] == '}')
 					break;
 				else if (p[0] == '\0')
-					throw;
+					return DataParseResult(DataError::INVALID_VALUE, static_cast<size_t>(p - format));
 				++p;
 			}
 			p = format + 3;
@@ -422,7 +691,7 @@ inline DataItem DataItem::createFromFormat(const char* format)
 		case 2: item.m_elementPointer = new uint16_t[c]; break;
 		case 4: item.m_elementPointer = new uint32_t[c]; break;
 		case 8: item.m_elementPointer = new uint64_t[c]; break;
-		default: throw;
+		default: return DataParseResult(DataError::UNSUPPORTED_SIZE, 3);
 		}
 
 		const char* p = format + 3;
@@ -448,7 +717,7 @@ inline DataItem DataItem::createFromFormat(const char* format)
 				else if ((p[0] == '}') && (i == c - 1))
 					break;
 				else
-					throw;
+					return DataParseResult(DataError::INVALID_VALUE, static_cast<size_t>(p - format));
 				++p;
 			}
 
@@ -460,7 +729,7 @@ inline DataItem DataItem::createFromFormat(const char* format)
 			case 8: static_cast<uint64_t*>(item.m_elementPointer)[i] = static_cast<uint64_t>(v); break;
 			}
 		}
-		return item;
+		return DataParseResult();
 	}
 
 	// REAL
@@ -478,7 +747,7 @@ inline DataItem DataItem::createFromFormat(const char* format)
 			item.m_elementPointer = new double(atof(format));
 		}
 		item.m_format = DataFormat::REAL;
-		return item;
+		return DataParseResult();
 	}
 
 	// REAL array
@@ -496,7 +765,7 @@ inline DataItem DataItem::createFromFormat(const char* format)
 				else if (p[0] == '}')
 					break;
 				else if (p[0] == '\0')
-					throw;
+					return DataParseResult(DataError::INVALID_VALUE, static_cast<size_t>(p - format));
 				++p;
 			}
 		}
@@ -521,7 +790,7 @@ inline DataItem DataItem::createFromFormat(const char* format)
 					else if ((p[0] == '}') && (i == c - 1))
 						break;
 					else if (p[0] == '\0')
-						throw;
+						return DataParseResult(DataError::INVALID_VALUE, static_cast<size_t>(p - format));
 				}
 			}
 		}
@@ -545,12 +814,12 @@ inline DataItem DataItem::createFromFormat(const char* format)
 					else if ((p[0] == '}') && (i == c - 1))
 						break;
 					else if (p[0] == '\0')
-						throw;
+						return DataParseResult(DataError::INVALID_VALUE, static_cast<size_t>(p - format));
 				}
 			}
 		}
 		item.m_format = DataFormat::REAL;
-		return item;
+		return DataParseResult();
 	}
 
 	// BOOL
@@ -559,7 +828,7 @@ inline DataItem DataItem::createFromFormat(const char* format)
 		item.m_elementSize = sizeof(bool);
 		item.m_elementPointer = new bool(format[0] == 't');
 		item.m_format = DataFormat::BOOL;
-		return item;
+		return DataParseResult();
 	}
 
 	// BOOL array
@@ -575,7 +844,7 @@ inline DataItem DataItem::createFromFormat(const char* format)
 				else if (p[0] == '}')
 					break;
 				else if (p[0] == '\0')
-					throw;
+					return DataParseResult(DataError::INVALID_VALUE, static_cast<size_t>(p - format));
 				++p;
 			}
 		}
@@ -599,10 +868,10 @@ inline DataItem DataItem::createFromFormat(const char* format)
 				else if ((p[0] == '}') && (i == c - 1))
 					break;
 				else if (p[0] == '\0')
-					throw;
+					return DataParseResult(DataError::INVALID_VALUE, static_cast<size_t>(p - format));
 			}
 		}
-		return item;
+		return DataParseResult();
 	}
 
 	// TEXT char
@@ -611,7 +880,7 @@ inline DataItem DataItem::createFromFormat(const char* format)
 		item.m_elementSize = sizeof(char);
 		item.m_elementPointer = new char(format[1]);
 		item.m_format = DataFormat::TEXT;
-		return item;
+		return DataParseResult();
 	}
 
 	// TEXT char array
@@ -627,7 +896,7 @@ inline DataItem DataItem::createFromFormat(const char* format)
 				else if (p[0] == '}')
 					break;
 				else if (p[0] == '\0')
-					throw;
+					return DataParseResult(DataError::INVALID_VALUE, static_cast<size_t>(p - format));
 				++p;
 			}
 		}
@@ -640,7 +909,7 @@ inline DataItem DataItem::createFromFormat(const char* format)
 		for (int i = 0; i < c; ++i)
 		{
 			if (p[0] == '\0' || p[1] == '\0' || p[2] == '\0' || p[3] == '\0')
-				throw;
+				return DataParseResult(DataError::INVALID_VALUE, static_cast<size_t>(p - format));
 
 			if (p[0] == '\'' && p[2] == '\'')
 			{
@@ -649,10 +918,10 @@ inline DataItem DataItem::createFromFormat(const char* format)
 				if (p[3] == ',')
 					p += 4;
 				else if (p[3] != '}')
-					throw;
+					return DataParseResult(DataError::INVALID_VALUE, static_cast<size_t>(p - format));
 			}
 		}
-		return item;
+		return DataParseResult();
 	}
 
 	// TEXT string
@@ -666,7 +935,7 @@ inline DataItem DataItem::createFromFormat(const char* format)
 				if (p[0] == '\"')
 					break;
 				else if (p[0] == '\0')
-					throw;
+					return DataParseResult(DataError::INVALID_VALUE, static_cast<size_t>(p - format));
 				++p;
 				++c;
 			}
@@ -681,164 +950,436 @@ inline DataItem DataItem::createFromFormat(const char* format)
 
 		static_cast<char*>(item.m_elementPointer)[c - 1] = '\0';
 
-		return item;
+		return DataParseResult();
+	}
+
+	// BITS
+	if (format[0] == '#' && format[1] == 'b' && format[2] == 'i' && format[3] == 't' && format[4] == 's' && format[5] == ':')
+	{
+		const char* p = format + 6;
+		size_t size = 0;
+		while ('0' <= p[0] && p[0] <= '9')
+		{
+			size_t d = static_cast<size_t>(p[0] - '0');
+			if (size > (SIZE_MAX - d) / 10)
+				return DataParseResult(DataError::INVALID_VALUE, static_cast<size_t>(p - format));
+			size = size * 10 + d;
+			++p;
+		}
+		if (p[0] != ':' || p == format + 6)
+			return DataParseResult(DataError::INVALID_VALUE, static_cast<size_t>(p - format));
+		++p;
+
+		// mۂOɁA16ǐvfƍƂm߂
+		size_t bytes = size / 8 + (size % 8 != 0 ? 1 : 0);
+		size_t length = strlen(p);
+		if (length % 2 != 0 || length / 2 != bytes)
+			return DataParseResult(DataError::INVALID_VALUE, static_cast<size_t>(p - format) + (length / 2 < bytes ? length : bytes * 2));
+
+		size_t n = DataConstBits::wordCount(size);
+		uint64_t* words = new uint64_t[1 + n]();
+		words[0] = size;
+		item.m_elementPointer = words;
+		item.m_elementSize = sizeof(uint64_t);
+		item.m_elementCount = 1 + n;
+		item.m_format = DataFormat::BITS;
+
+		for (size_t i = 0; i < bytes * 2; ++i)
+		{
+			uint64_t v;
+			if ('0' <= p[i] && p[i] <= '9')
+				v = p[i] - '0';
+			else if ('A' <= p[i] && p[i] <= 'F')
+				v = p[i] - 'A' + 10;
+			else
+				return DataParseResult(DataError::INVALID_VALUE, static_cast<size_t>(p - format) + i);
+
+			// ڂ4rbg
+			words[1 + i / 16] |= v << ((i / 2 % 8) * 8 + (i % 2 == 0 ? 4 : 0));
+		}
+
+		// vf𒴂rbgĂΎs (]rbg͏0ɂĂ)
+		if (size % 64 != 0 && (words[n] >> (size % 64)) != 0)
+			return DataParseResult(DataError::INVALID_VALUE, static_cast<size_t>(p - format) + bytes * 2 - 1);
+		return DataParseResult();
+	}
+
+	// PACKED
+	if (format[0] == '#' && format[1] == 'p' && format[2] == 'k' && format[3] == ':')
+	{
+		const char* p = format + 4;
+		int s = 0;
+		while ('0' <= p[0] && p[0] <= '9')
+		{
+			if (s > 8)
+				return DataParseResult(DataError::UNSUPPORTED_SIZE, 4);
+			s = s * 10 + (p[0] - '0');
+			++p;
+		}
+		if (p[0] != ':')
+			return DataParseResult(DataError::INVALID_VALUE, static_cast<size_t>(p - format));
+		++p;
+
+		const char* countText = p;
+		size_t c = 0;
+		while ('0' <= p[0] && p[0] <= '9')
+		{
+			size_t d = static_cast<size_t>(p[0] - '0');
+			if (c > (SIZE_MAX - d) / 10)
+				return DataParseResult(DataError::INVALID_VALUE, static_cast<size_t>(p - format));
+			c = c * 10 + d;
+			++p;
+		}
+		if (p[0] != ':' || p == countText)
+			return DataParseResult(DataError::INVALID_VALUE, static_cast<size_t>(p - format));
+		++p;
+
+		const char* q = p;
+		while (p[0] != ':' && p[0] != '\0')
+			++p;
+		DataCodecType codec;
+		if (p[0] != ':' || !DataCodec::find(q, static_cast<size_t>(p - q), codec))
+			return DataParseResult(DataError::INVALID_VALUE, static_cast<size_t>(q - format));
+		++p;
+
+		size_t length = strlen(p);
+		size_t bytes = DataBase64::decodedSize(p, length);
+		if (bytes == 0 || c == 0 || (s != 1 && s != 2 && s != 4 && s != 8))
+			return DataParseResult(DataError::UNSUPPORTED_SIZE, 4);
+
+		// mۂOɁAl߂oCgɎ܂vfm߂
+		if (c > DataCodec::maxCount(codec, s, bytes))
+			return DataParseResult(DataError::INVALID_VALUE, static_cast<size_t>(countText - format));
+
+		switch (s)
+		{
+		case 1: item.m_elementPointer = new uint8_t[c]; break;
+		case 2: item.m_elementPointer = new uint16_t[c]; break;
+		case 4: item.m_elementPointer = new uint32_t[c]; break;
+		case 8: item.m_elementPointer = new uint64_t[c]; break;
+		}
+		item.m_elementSize = s;
+		item.m_elementCount = c;
+		item.m_format = DataFormat::PACKED;
+
+		// l߂oCg͌ǂ݉ẑŗ]t
+		std::unique_ptr<uint8_t[]> buffer(new uint8_t[bytes + DataCodec::PADDING]());
+		DataParseResult r = DataBase64::decode(p, length, buffer.get());
+		if (!r)
+			return DataParseResult(r.error, static_cast<size_t>(p - format) + r.position);
+		r = DataCodec::decode(codec, item.m_elementSize, item.m_elementCount, buffer.get(), bytes, item.m_elementPointer);
+		if (!r)
+			return DataParseResult(r.error, static_cast<size_t>(p - format) + r.position / 3 * 4);
+		return DataParseResult();
+	}
+
+	// BLOB
+	if (format[0] == '#' && format[1] == 'b' && format[2] == '6' && format[3] == '4' && format[4] == ':')
+	{
+		const char* p = format + 5;
+		int s = 0;
+		while ('0' <= p[0] && p[0] <= '9')
+		{
+			if (s > 8)
+				return DataParseResult(DataError::UNSUPPORTED_SIZE, 5);
+			s = s * 10 + (p[0] - '0');
+			++p;
+		}
+		if (p[0] != ':')
+			return DataParseResult(DataError::INVALID_VALUE, static_cast<size_t>(p - format));
+		++p;
+
+		size_t length = strlen(p);
+		size_t bytes = DataBase64::decodedSize(p, length);
+		if (bytes == 0 || (s != 1 && s != 2 && s != 4 && s != 8) || bytes % s != 0)
+			return DataParseResult(DataError::UNSUPPORTED_SIZE, 5);
+
+		size_t c = bytes / s;
+		switch (s)
+		{
+		case 1: item.m_elementPointer = new uint8_t[c]; break;
+		case 2: item.m_elementPointer = new uint16_t[c]; break;
+		case 4: item.m_elementPointer = new uint32_t[c]; break;
+		case 8: item.m_elementPointer = new uint64_t[c]; break;
+		}
+		item.m_elementSize = s;
+		item.m_elementCount = c;
+		item.m_format = DataFormat::BLOB;
+
+		DataParseResult r = DataBase64::decode(p, length, item.m_elementPointer);
+		if (!r)
+			return DataParseResult(r.error, static_cast<size_t>(p - format) + r.position);
+		return DataParseResult();
+	}
+
+	return DataParseResult(DataError::INVALID_VALUE, 0);
+}
+
+inline DataItem DataItem::createFromMemory(size_t elementSize, size_t elementCount, DataFormat format, const void* elementPointer)
+{
+	DataItem item;
+	FDA_TRACE_COUNT(DataTraceCounter::PAYLOAD_ALLOCATION);
+	switch (elementSize)
+	{
+	case 1: item.m_elementPointer = elementCount == 0 ? new uint8_t : new uint8_t[elementCount]; break;
+	case 2: item.m_elementPointer = elementCount == 0 ? new uint16_t : new uint16_t[elementCount]; break;
+	case 4: item.m_elementPointer = elementCount == 0 ? new uint32_t : new uint32_t[elementCount]; break;
+	case 8: item.m_elementPointer = elementCount == 0 ? new uint64_t : new uint64_t[elementCount]; break;
+	default: throw std::invalid_argument("DataItem: unsupported element size");
 	}
+	memcpy(item.m_elementPointer, elementPointer, elementSize * (elementCount == 0 ? 1 : elementCount));
 
-	throw;
+	item.m_elementSize = elementSize;
+	item.m_elementCount = elementCount;
+	item.m_format = format;
+	return item;
+}
+
+inline DataItem DataItem::createBits(size_t size, bool value)
+{
+	// 擪̃[hɃrbg
+	size_t n = DataConstBits::wordCount(size);
+	DataItem item;
+	FDA_TRACE_COUNT(DataTraceCounter::PAYLOAD_ALLOCATION);
+	uint64_t* words = new uint64_t[1 + n];
+	words[0] = size;
+	DataBits(words + 1, size).fill(value);
+
+	item.m_elementPointer = words;
+	item.m_elementSize = sizeof(uint64_t);
+	item.m_elementCount = 1 + n;
+	item.m_format = DataFormat::BITS;
+	return item;
+}
+
+inline DataItem DataItem::createFromMapping(DataMappedFile& file, size_t offset, size_t elementSize, size_t elementCount, DataFormat format)
+{
+	char* data = file.writableData();
+	if (!data)
+		throw std::invalid_argument("DataItem: file not mapped writable");
+	if (elementSize != 1 && elementSize != 2 && elementSize != 4 && elementSize != 8)
+		throw std::invalid_argument("DataItem: unsupported element size");
+	if (elementCount == 0 || offset % elementSize != 0 || offset > file.size() || elementCount > (file.size() - offset) / elementSize)
+		throw std::out_of_range("DataItem: mapping out of range");
+
+	// l̓t@Cɂ̂ŊmۂȂ
+	DataItem item;
+	item.m_elementPointer = data + offset;
+	item.m_elementSize = elementSize;
+	item.m_elementCount = elementCount;
+	item.m_format = format;
+	item.m_mapped = true;
 	return item;
 }
 
 inline const char* DataItem::operator()() const
 {
+	if (m_interned)
+		return DataInternPool::entry(m_elementPointer)->text.c_str();
 	if (m_cache)
 		return m_text.c_str();
 
+	FDA_TRACE_COUNT(DataTraceCounter::TEXT_CACHE_MISS);
+
+	m_text.clear();
+	appendFormat(m_text, m_format, m_elementSize, m_elementCount, m_elementPointer);
 	m_cache = true;
 
+	return m_text.c_str();
+}
+
+inline void DataItem::appendFormat(std::string& text, DataFormat format, size_t elementSize, size_t elementCount, const void* elementPointer)
+{
 	char buf[32] = {};
-	switch (m_format)
+	switch (format)
 	{
 	case DataFormat::HEX:
 	{
-		if (m_elementCount == 0)
+		if (elementCount == 0)
 		{
-			switch (m_elementSize)
+			switch (elementSize)
 			{
-			case 1: sprintf_s(buf, "0x%02X", *static_cast<uint8_t*>(m_elementPointer)); break;
-			case 2: sprintf_s(buf, "0x%04X", *static_cast<uint16_t*>(m_elementPointer)); break;
-			case 4: sprintf_s(buf, "0x%08X", *static_cast<uint32_t*>(m_elementPointer)); break;
-			case 8: sprintf_s(buf, "0x%016llX", *static_cast<uint64_t*>(m_elementPointer)); break;
-			default: throw;
+			case 1: sprintf_s(buf, "0x%02X", *static_cast<const uint8_t*>(elementPointer)); break;
+			case 2: sprintf_s(buf, "0x%04X", *static_cast<const uint16_t*>(elementPointer)); break;
+			case 4: sprintf_s(buf, "0x%08X", *static_cast<const uint32_t*>(elementPointer)); break;
+			case 8: sprintf_s(buf, "0x%016llX", *static_cast<const uint64_t*>(elementPointer)); break;
+			default: throw std::invalid_argument("DataItem: unsupported element size");
 			}
-			m_text = buf;
+			text.append(buf);
 		}
 		else
 		{
 			struct Fnc
 			{
-				void* ep;
+				const void* ep;
 				char(&buf)[32];
-				void byte1(int c) { sprintf_s(buf, "0x%02X,", static_cast<uint8_t*>(ep)[c]); }
-				void byte2(int c) { sprintf_s(buf, "0x%04X,", static_cast<uint16_t*>(ep)[c]); }
-				void byte4(int c) { sprintf_s(buf, "0x%08X,", static_cast<uint32_t*>(ep)[c]); }
-				void byte8(int c) { sprintf_s(buf, "0x%016llX,", static_cast<uint64_t*>(ep)[c]); }
-			} fnc = {m_elementPointer, buf};
+				void byte1(int c) { sprintf_s(buf, "0x%02X,", static_cast<const uint8_t*>(ep)[c]); }
+				void byte2(int c) { sprintf_s(buf, "0x%04X,", static_cast<const uint16_t*>(ep)[c]); }
+				void byte4(int c) { sprintf_s(buf, "0x%08X,", static_cast<const uint32_t*>(ep)[c]); }
+				void byte8(int c) { sprintf_s(buf, "0x%016llX,", static_cast<const uint64_t*>(ep)[c]); }
+			} fnc = {elementPointer, buf};
 			void(Fnc::*fncP)(int c) = nullptr;
-			switch (m_elementSize)
+			switch (elementSize)
 			{
 			case 1: fncP = &Fnc::byte1; break;
 			case 2: fncP = &Fnc::byte2; break;
 			case 4: fncP = &Fnc::byte4; break;
 			case 8: fncP = &Fnc::byte8; break;
-			default: throw;
+			default: throw std::invalid_argument("DataItem: unsupported element size");
 			}
-			m_text = "{";
-			for (int c = 0; c < m_elementCount; ++c)
+			text.append("{");
+			for (int c = 0; c < elementCount; ++c)
 			{
 				(fnc.*fncP)(c);
-				m_text.append(buf);
+				text.append(buf);
 			}
-			m_text[m_text.size() - 1] = '}';
+			text[text.size() - 1] = '}';
 		}
 	}
 	break;
 	case DataFormat::REAL:
 	{
-		if (m_elementCount == 0)
+		if (elementCount == 0)
 		{
-			switch (m_elementSize)
+			switch (elementSize)
 			{
-			case sizeof(float): sprintf_s(buf, "$%.15g", *static_cast<float*>(m_elementPointer)); break;
-			case sizeof(double): sprintf_s(buf, "%.15g", *static_cast<double*>(m_elementPointer)); break;
-			default: throw;
+			case sizeof(float): sprintf_s(buf, "$%.15g", *static_cast<const float*>(elementPointer)); break;
+			case sizeof(double): sprintf_s(buf, "%.15g", *static_cast<const double*>(elementPointer)); break;
+			default: throw std::invalid_argument("DataItem: unsupported element size");
 			}
 			
-			m_text = buf;
+			text.append(buf);
 		}
 		else
 		{
 			struct Fnc
 			{
-				void* ep;
+				const void* ep;
 				char(&buf)[32];
-				void f(int c) { sprintf_s(buf, "$%.15g,", static_cast<float*>(ep)[c]); }
-				void d(int c) { sprintf_s(buf, "%.15g,", static_cast<double*>(ep)[c]); }
-			} fnc = {m_elementPointer, buf};
+				void f(int c) { sprintf_s(buf, "$%.15g,", static_cast<const float*>(ep)[c]); }
+				void d(int c) { sprintf_s(buf, "%.15g,", static_cast<const double*>(ep)[c]); }
+			} fnc = {elementPointer, buf};
 			void(Fnc:: * fncP)(int c) = nullptr;
-			switch (m_elementSize)
+			switch (elementSize)
 			{
 			case sizeof(float): fncP = &Fnc::f; break;
 			case sizeof(double): fncP = &Fnc::d; break;
-			default: throw;
+			default: throw std::invalid_argument("DataItem: unsupported element size");
 			}
-			m_text = "{";
-			for (int c = 0; c < m_elementCount; ++c)
+			text.append("{");
+			for (int c = 0; c < elementCount; ++c)
 			{
 				(fnc.*fncP)(c);
-				m_text.append(buf);
+				text.append(buf);
 			}
-			m_text[m_text.size() - 1] = '}';
+			text[text.size() - 1] = '}';
 		}
 	}
 	break;
 	case DataFormat::BOOL:
 	{
-		if (m_elementSize != 1)
-			throw;
+		if (elementSize != 1)
+			throw std::invalid_argument("DataItem: format not supported by element size");
 
-		if (m_elementCount == 0)
+		// }bvt@C̒l01Ƃ͌Ȃ̂ŁAboolƂĂł͂ȂoCgƂēǂ
+		if (elementCount == 0)
 		{
-			sprintf_s(buf, "%s", *static_cast<bool*>(m_elementPointer) ? "true" : "false");
-			m_text = buf;
+			sprintf_s(buf, "%s", *static_cast<const uint8_t*>(elementPointer) != 0 ? "true" : "false");
+			text.append(buf);
 		}
 		else
 		{
-			m_text = "{";
-			for (int c = 0; c < m_elementCount; ++c)
+			text.append("{");
+			for (int c = 0; c < elementCount; ++c)
 			{
-				sprintf_s(buf, "%s,", static_cast<bool*>(m_elementPointer)[c] ? "true" : "false");
-				m_text.append(buf);
+				sprintf_s(buf, "%s,", static_cast<const uint8_t*>(elementPointer)[c] != 0 ? "true" : "false");
+				text.append(buf);
 			}
-			m_text[m_text.size() - 1] = '}';
+			text[text.size() - 1] = '}';
 		}
 	}
 	break;
 	case DataFormat::TEXT:
 	{
-		if (m_elementSize != 1)
-			throw;
+		if (elementSize != 1)
+			throw std::invalid_argument("DataItem: format not supported by element size");
 
-		if (m_elementCount == 0)
+		if (elementCount == 0)
 		{
-			m_text = '\'';
-			m_text += *static_cast<char*>(m_elementPointer);
-			m_text += '\'';
+			text += '\'';
+			text += *static_cast<const char*>(elementPointer);
+			text += '\'';
 		}
 		else
 		{
-			if (static_cast<char*>(m_elementPointer)[m_elementCount - 1] == '\0')
+			if (static_cast<const char*>(elementPointer)[elementCount - 1] == '\0')
 			{
-				m_text = '\"';
-				m_text.append(static_cast<char*>(m_elementPointer));
-				m_text.append("\"");
+				text += '\"';
+				text.append(static_cast<const char*>(elementPointer));
+				text.append("\"");
 			}
 			else
 			{
-				m_text = "{";
-				for (int c = 0; c < m_elementCount; ++c)
+				text.append("{");
+				for (int c = 0; c < elementCount; ++c)
 				{
-					sprintf_s(buf, "\'%c\',", static_cast<char*>(m_elementPointer)[c]);
-					m_text.append(buf);
+					sprintf_s(buf, "\'%c\',", static_cast<const char*>(elementPointer)[c]);
+					text.append(buf);
 				}
-				m_text[m_text.size() - 1] = '}';
+				text[text.size() - 1] = '}';
 			}
 		}
 	}
 	break;
+	case DataFormat::BITS:
+	{
+		if (elementSize != sizeof(uint64_t) || elementCount == 0)
+			throw std::invalid_argument("DataItem: format not supported by element size");
+
+		const uint64_t* words = static_cast<const uint64_t*>(elementPointer);
+		size_t size = static_cast<size_t>(words[0]);
+		sprintf_s(buf, "#bits:%llu:", static_cast<unsigned long long>(size));
+		text.append(buf);
+
+		// 8vf1oCgƂāA擪̗vf珇16i2ŕ\
+		static const char digits[] = "0123456789ABCDEF";
+		size_t bytes = (size + 7) / 8;
+		size_t n = text.size();
+		text.resize(n + bytes * 2);
+		char* o = &text[n];
+		for (size_t i = 0; i < bytes; ++i)
+		{
+			uint8_t b = static_cast<uint8_t>(words[1 + i / 8] >> ((i % 8) * 8));
+			o[i * 2] = digits[b >> 4];
+			o[i * 2 + 1] = digits[b & 0x0F];
+		}
+	}
+	break;
+	case DataFormat::BLOB:
+	{
+		if (elementCount == 0)
+			throw std::invalid_argument("DataItem: format not supported by element size");
+
+		sprintf_s(buf, "#b64:%d:", static_cast<int>(elementSize));
+		text.append(buf);
+		DataBase64::encode(elementPointer, elementSize * elementCount, text);
+	}
+	break;
+	case DataFormat::PACKED:
+	{
+		if (elementCount == 0)
+			throw std::invalid_argument("DataItem: format not supported by element size");
+
+		std::string bytes;
+		DataCodecType codec = DataCodec::encode(elementSize, elementCount, elementPointer, bytes);
+		sprintf_s(buf, "#pk:%d:%llu:%s:", static_cast<int>(elementSize), static_cast<unsigned long long>(elementCount), DataCodec::name(codec));
+		text.append(buf);
+		DataBase64::encode(bytes.data(), bytes.size(), text);
+	}
+	break;
 	default:
-		throw;
+		throw std::invalid_argument("DataItem: unsupported format");
 	}
-	return m_text.c_str();
 }
 
 template<typename T>
@@ -847,7 +1388,7 @@ inline DataItem::operator T() const
 	static_assert(!std::is_pointer_v<T> && !std::is_array_v<T>, "|C^Ez͖");
 
 	if (std::alignment_of_v<T> != m_elementSize)
-		throw;
+		throw std::runtime_error("DataItem: type mismatch");
 
 	return *static_cast<T*>(m_elementPointer);
 }
@@ -858,7 +1399,29 @@ inline DataItem::operator T* () const
 	static_assert(!std::is_pointer_v<T> && !std::is_array_v<T>, "|C^Ez͖");
 
 	if (std::alignment_of_v<T> != m_elementSize)
-		throw;
+		throw std::runtime_error("DataItem: type mismatch");
+
+	return static_cast<T*>(m_elementPointer);
+}
+
+template<typename T>
+inline std::optional<T> DataItem::tryAs() const
+{
+	static_assert(!std::is_pointer_v<T> && !std::is_array_v<T>, "|C^Ez͖");
+
+	if (std::alignment_of_v<T> != m_elementSize)
+		return std::nullopt;
+
+	return *static_cast<T*>(m_elementPointer);
+}
+
+template<typename T>
+inline T* DataItem::tryPointer() const
+{
+	static_assert(!std::is_pointer_v<T> && !std::is_array_v<T>, "|C^Ez͖");
+
+	if (std::alignment_of_v<T> != m_elementSize)
+		return nullptr;
 
 	return static_cast<T*>(m_elementPointer);
 }
@@ -867,29 +1430,105 @@ template<typename T>
 inline void DataItem::operator=(T element)
 {
 	static_assert(!std::is_pointer_v<T> && !std::is_array_v<T>, "|C^Ez͖");
+	beforeChange(DataChange::ITEM);
 
 	if (std::alignment_of_v<T> != m_elementSize)
-		throw;
+		throw std::runtime_error("DataItem: type mismatch");
 
+	detach();
 	*static_cast<T*>(m_elementPointer) = element;
 	m_cache = false;
+	invalidateHash();
 }
 
 template<typename T>
 inline void DataItem::operator<<(T element)
 {
 	static_assert(!std::is_pointer_v<T> && !std::is_array_v<T>, "|C^Ez͖");
+	beforeChange(DataChange::ITEM);
 	m_elementSize = std::alignment_of_v<T>;
 	m_elementCount = 0;
 	deleteData();
+	FDA_TRACE_COUNT(DataTraceCounter::PAYLOAD_ALLOCATION);
 	m_elementPointer = new T(element);
 	m_format = getDefaultFormat<T>();
 	m_cache = false;
+	invalidateHash();
+}
+
+template<typename T>
+inline bool DataItem::convertTo(DataConvertMode mode)
+{
+	switch (m_format)
+	{
+	case DataFormat::REAL:
+		if (m_elementSize == sizeof(float))
+			return convertTo<T, float>(mode);
+		return convertTo<T, double>(mode);
+	case DataFormat::BOOL:
+		return convertTo<T, bool>(mode);
+	case DataFormat::TEXT:
+		return convertTo<T, char>(mode);
+	case DataFormat::BITS:
+		// bool͂ǂ̌^ɂ͈͓ŕϊł̂ŁAɍLĂsȂ
+		unpack();
+		return convertTo<T, bool>(mode);
+	default:
+		break;
+	}
+
+	switch (m_elementSize)
+	{
+	case 1: return convertTo<T, uint8_t>(mode);
+	case 2: return convertTo<T, uint16_t>(mode);
+	case 4: return convertTo<T, uint32_t>(mode);
+	case 8: return convertTo<T, uint64_t>(mode);
+	default: throw std::invalid_argument("DataItem: unsupported element size");
+	}
+}
+
+template<typename T, typename From>
+inline bool DataItem::convertTo(DataConvertMode mode)
+{
+	static_assert(std::is_arithmetic_v<T> && std::is_arithmetic_v<From>, "l^̂");
+
+	if (std::alignment_of_v<From> != m_elementSize || m_format == DataFormat::BITS)
+		throw std::runtime_error("DataItem: type mismatch");
+
+	size_t count = m_elementCount == 0 ? 1 : m_elementCount;
+	const From* source = static_cast<const From*>(m_elementPointer);
+	if (mode == DataConvertMode::CHECKED && !DataConverter::inRange<From, T>(source, count))
+		return false;
+
+	beforeChange(DataChange::ITEM);
+
+	// Ȃꍇ͑O珇ɏ㏑Ăϊ̗vf󂳂Ȃ
+	// t@CɃ}bvĺAt@C̔zuςȂ悤ɕϊ
+	if (std::alignment_of_v<T> <= m_elementSize && !m_mapped)
+	{
+		detach();
+		DataConverter::convert(static_cast<const From*>(m_elementPointer), static_cast<T*>(m_elementPointer), count);
+	}
+	else
+	{
+		FDA_TRACE_COUNT(DataTraceCounter::PAYLOAD_ALLOCATION);
+		T* destination = m_elementCount == 0 ? new T : new T[count];
+		DataConverter::convert(source, destination, count);
+		deleteData();
+		m_elementPointer = destination;
+	}
+
+	m_elementSize = std::alignment_of_v<T>;
+	m_format = getDefaultFormat<T>();
+	m_cache = false;
+	invalidateHash();
+	return true;
 }
 
 template<typename T>
 inline void DataItem::shallow(T* elementPointer, size_t elementCount)
 {
+	beforeChange(DataChange::ITEM);
 	m_elementSize = std::alignment_of_v<T>;
 	m_elementCount = elementCount;
 
@@ -897,19 +1536,23 @@ inline void DataItem::shallow(T* elementPointer, size_t elementCount)
 	m_elementPointer = elementPointer;
 	m_format = getDefaultFormat<T>();
 	m_cache = false;
+	invalidateHash();
 }
 
 template<typename T>
 inline void DataItem::deep(const T* elementPointer, size_t elementCount)
 {
+	beforeChange(DataChange::ITEM);
 	m_elementSize = std::alignment_of_v<T>;
 	m_elementCount = elementCount;
 
 	deleteData();
+	FDA_TRACE_COUNT(DataTraceCounter::PAYLOAD_ALLOCATION);
 	m_elementPointer = new T[elementCount];
 	memcpy(m_elementPointer, elementPointer, m_elementSize * elementCount);
 	m_format = getDefaultFormat<T>();
 	m_cache = false;
+	invalidateHash();
 }
 
 inline size_t DataItem::getElementSize() const
@@ -922,29 +1565,236 @@ inline size_t DataItem::getElementCount() const
 	return m_elementCount;
 }
 
+inline const void* DataItem::getElementPointer() const
+{
+	return m_elementPointer;
+}
+
 inline DataFormat DataItem::getFormat() const
 {
 	return m_format;
 }
 
+inline uint64_t DataItem::hash() const
+{
+	if (m_hashCache)
+		return m_hash;
+
+	uint64_t h = DataHash::combine(m_elementSize, m_elementCount);
+	h = DataHash::combine(h, static_cast<uint64_t>(m_format));
+	// [u͒lȂ̂ŁAl̃oCgƂċ߂
+	size_t size = m_elementPointer ? m_elementSize * (m_elementCount == 0 ? 1 : m_elementCount) : 0;
+	m_hash = DataHash::bytes(m_elementPointer, size, h);
+	m_hashCache = true;
+	return m_hash;
+}
+
 inline void DataItem::setFormat(DataFormat format)
 {
+	beforeChange(DataChange::ITEM);
+
+	// BITSƂ̊Ԃ͒l̎ƕς
+	if (m_format == DataFormat::BITS || format == DataFormat::BITS)
+	{
+		if (m_format == format)
+			return;
+		if (format == DataFormat::BITS && m_format == DataFormat::BOOL && m_elementCount != 0)
+			pack();
+		else if (m_format == DataFormat::BITS && format == DataFormat::BOOL)
+			unpack();
+		else
+			throw std::invalid_argument("DataItem: format not supported by element size");
+		return;
+	}
+
 	if (format == DataFormat::HEX
 		|| (format == DataFormat::REAL && (m_elementSize == sizeof(double) || m_elementSize == sizeof(float)))
 		|| (format == DataFormat::BOOL && m_elementSize == sizeof(bool))
-		|| (format == DataFormat::TEXT && m_elementSize == sizeof(char)))
+		|| (format == DataFormat::TEXT && m_elementSize == sizeof(char))
+		|| ((format == DataFormat::BLOB || format == DataFormat::PACKED) && m_elementCount != 0))
 	{
+		// LĂl͏^CvƓo^Ă̂ŁA^CvςȂ狤L߂
+		if (format != m_format)
+			detach();
 		m_format = format;
 		m_cache = false;
+		invalidateHash();
 	}
 	else
 	{
-		throw;
+		throw std::invalid_argument("DataItem: format not supported by element size");
+	}
+}
+
+inline bool DataItem::equals(const DataItem& rhs) const
+{
+	// v[ɂ͓l1o^Ȃ
+	if (m_interned && rhs.m_interned)
+	{
+		DataInternPool* pool = DataInternPool::entry(m_elementPointer)->pool;
+		if (pool != nullptr && pool == DataInternPool::entry(rhs.m_elementPointer)->pool)
+			return m_elementPointer == rhs.m_elementPointer;
+	}
+
+	return m_elementSize == rhs.m_elementSize
+		&& m_elementCount == rhs.m_elementCount
+		&& m_format == rhs.m_format
+		&& (m_elementPointer == rhs.m_elementPointer
+			|| (m_elementPointer && rhs.m_elementPointer && memcmp(m_elementPointer, rhs.m_elementPointer, m_elementSize * (m_elementCount == 0 ? 1 : m_elementCount)) == 0));
+}
+
+inline void DataItem::intern(DataInternPool& pool)
+{
+	if ((m_interned && DataInternPool::entry(m_elementPointer)->pool == &pool) || m_mapped)
+		return;
+
+	// l͕ςȂ̂ŃnbVl͖ɂȂ
+	beforeChange(DataChange::ITEM);
+	uint64_t h = hash();
+	std::string text = (*this)();
+	void* p = pool.acquire(m_elementSize, m_elementCount, m_format, m_elementPointer, h, std::move(text));
+	deleteData();
+	m_elementPointer = p;
+	m_interned = true;
+	std::string().swap(m_text);
+	m_cache = false;
+}
+
+inline bool DataItem::interned() const
+{
+	return m_interned;
+}
+
+inline bool DataItem::mapped() const
+{
+	return m_mapped;
+}
+
+inline void DataItem::prefetch(size_t first, size_t count) const
+{
+	if (!m_mapped || first >= m_elementCount)
+		return;
+	if (count > m_elementCount - first)
+		count = m_elementCount - first;
+	DataMappedFile::prefetch(static_cast<const char*>(m_elementPointer) + first * m_elementSize, count * m_elementSize);
+}
+
+inline bool DataItem::flush() const
+{
+	if (!m_mapped)
+		return true;
+	return DataMappedFile::flush(m_elementPointer, m_elementSize * m_elementCount);
+}
+
+inline void DataItem::evict(size_t first, size_t count) const
+{
+	if (!m_mapped || first >= m_elementCount)
+		return;
+	if (count > m_elementCount - first)
+		count = m_elementCount - first;
+	DataMappedFile::evict(static_cast<const char*>(m_elementPointer) + first * m_elementSize, count * m_elementSize);
+}
+
+inline void DataItem::detach()
+{
+	if (!m_interned)
+		return;
+
+	const DataInternPool::Entry* e = DataInternPool::entry(m_elementPointer);
+	size_t n = DataInternPool::bytes(m_elementSize, m_elementCount);
+	FDA_TRACE_COUNT(DataTraceCounter::PAYLOAD_ALLOCATION);
+	void* p = nullptr;
+	switch (m_elementSize)
+	{
+	case 1: p = m_elementCount == 0 ? static_cast<void*>(new uint8_t) : new uint8_t[m_elementCount]; break;
+	case 2: p = m_elementCount == 0 ? static_cast<void*>(new uint16_t) : new uint16_t[m_elementCount]; break;
+	case 4: p = m_elementCount == 0 ? static_cast<void*>(new uint32_t) : new uint32_t[m_elementCount]; break;
+	case 8: p = m_elementCount == 0 ? static_cast<void*>(new uint64_t) : new uint64_t[m_elementCount]; break;
+	default: throw std::invalid_argument("DataItem: unsupported element size");
 	}
+	memcpy(p, m_elementPointer, n);
+	m_text = e->text;
+	m_cache = true;
+
+	deleteData();
+	m_elementPointer = p;
+}
+
+inline DataBits DataItem::bits()
+{
+	if (m_format != DataFormat::BITS)
+		throw std::runtime_error("DataItem: not packed bits");
+
+	beforeChange(DataChange::ITEM);
+	detach();
+	m_cache = false;
+	invalidateHash();
+	uint64_t* words = static_cast<uint64_t*>(m_elementPointer);
+	return DataBits(words + 1, static_cast<size_t>(words[0]));
+}
+
+inline DataConstBits DataItem::bits() const
+{
+	if (m_format != DataFormat::BITS)
+		throw std::runtime_error("DataItem: not packed bits");
+
+	const uint64_t* words = static_cast<const uint64_t*>(m_elementPointer);
+	return DataConstBits(words + 1, static_cast<size_t>(words[0]));
+}
+
+inline void DataItem::pack()
+{
+	beforeChange(DataChange::ITEM);
+	size_t size = m_elementCount;
+	size_t n = DataConstBits::wordCount(size);
+	FDA_TRACE_COUNT(DataTraceCounter::PAYLOAD_ALLOCATION);
+	uint64_t* words = new uint64_t[1 + n];
+	words[0] = size;
+	DataConstBits::pack(static_cast<const bool*>(m_elementPointer), size, words + 1);
+
+	deleteData();
+	m_elementPointer = words;
+	m_elementSize = sizeof(uint64_t);
+	m_elementCount = 1 + n;
+	m_format = DataFormat::BITS;
+	m_cache = false;
+	invalidateHash();
+}
+
+inline void DataItem::unpack()
+{
+	beforeChange(DataChange::ITEM);
+	const uint64_t* words = static_cast<const uint64_t*>(m_elementPointer);
+	size_t size = static_cast<size_t>(words[0]);
+	FDA_TRACE_COUNT(DataTraceCounter::PAYLOAD_ALLOCATION);
+	bool* values = new bool[size == 0 ? 1 : size];
+	DataConstBits::unpack(words + 1, size, values);
+
+	deleteData();
+	m_elementPointer = values;
+	m_elementSize = sizeof(bool);
+	m_elementCount = size;
+	m_format = DataFormat::BOOL;
+	m_cache = false;
+	invalidateHash();
 }
 
 inline void DataItem::deleteData()
 {
+	if (m_interned)
+	{
+		DataInternPool::release(m_elementPointer);
+		m_interned = false;
+		return;
+	}
+
+	// t@C̒l̓}bvDataMappedFile
+	if (m_mapped)
+	{
+		m_mapped = false;
+		return;
+	}
+
 	if (m_elementCount == 0)
 		delete m_elementPointer;
 	else
@@ -0,0 +1,376 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/// <summary>
+/// <para>DataMappedFileŃt@C}bv@</para>
+/// <para>READ=ǂݎp, COPY=邪t@Cɂ͔fȂ, WRITE=ƃt@Cɔf</para>
+/// </summary>
+enum class DataMapMode
+{
+	READ,
+	COPY,
+	WRITE
+};
+
+/// <summary>
+/// <para>t@CɃ}bvNX</para>
+/// <para>t@C}bṽvZXOS̃y[WLbVL</para>
+/// <para>}bv̈͐Gꂽy[Wǂݍ܂AgĂȂy[WOSKvɉĎ</para>
+/// </summary>
+class DataMappedFile
+{
+public:
+	DataMappedFile();
+	~DataMappedFile();
+
+	DataMappedFile(const DataMappedFile&) = delete;
+	DataMappedFile& operator=(const DataMappedFile&) = delete;
+
+public:
+	/// <summary>
+	/// <para>t@C}bv</para>
+	/// <para>Ƀ}bvĂt@C͕</para>
+	/// </summary>
+	/// <param name="path">t@CpX</param>
+	/// <param name="mode">}bv@</param>
+	/// <returns>true=, false=s</returns>
+	bool open(const char* path, DataMapMode mode = DataMapMode::READ);
+
+	/// <summary>
+	/// <para>sizeoCg̃t@CVAWRITEŃ}bv</para>
+	/// <para>Ƀt@Cꍇ͒ĝĂB̒g͑S0</para>
+	/// <para>Ƀ}bvĂt@C͕</para>
+	/// </summary>
+	/// <param name="path">t@CpX</param>
+	/// <param name="size">t@C̃oCg (0͎s)</param>
+	/// <returns>true=, false=s</returns>
+	bool create(const char* path, size_t size);
+
+	/// <summary>
+	/// <para>}bvăt@C</para>
+	/// </summary>
+	void close();
+
+	/// <returns>}bv̐擪 (JĂȂꍇnullptr)</returns>
+	const char* data() const;
+
+	/// <returns>
+	/// <para>}bv̐擪</para>
+	/// <para>JĂȂꍇREADŊJĂꍇnullptr</para>
+	/// </returns>
+	char* writableData() const;
+
+	/// <returns>}bvt@C̃oCg</returns>
+	size_t size() const;
+
+	/// <returns>}bv@</returns>
+	DataMapMode mode() const;
+
+	/// <summary>
+	/// <para>[offset, offset+size)͈̔͂Oēǂݍނ悤OSɗv</para>
+	/// <para>t@C͈̔͂𒴂镔͖</para>
+	/// </summary>
+	void prefetch(size_t offset, size_t size) const;
+
+	/// <summary>
+	/// <para>WRITEŏet@CɏoAI܂ő҂</para>
+	/// <para>READCOPY̏ꍇ͉Ȃ</para>
+	/// </summary>
+	/// <returns>true=, false=s</returns>
+	bool flush() const;
+
+	/// <summary>
+	/// <para>}bv[data, data+size)͈̔͂Oēǂݍނ悤OSɗv</para>
+	/// <para>ǂDataMappedFilë̗悩mȂĂĂׂBy[WEɑKvȂ</para>
+	/// </summary>
+	static void prefetch(const void* data, size_t size);
+
+	/// <summary>
+	/// <para>}bv[data, data+size)͈̔͂̕ύXt@Cɏo</para>
+	/// <para>ǂDataMappedFilë̗悩mȂĂĂׂBy[WEɑKvȂ</para>
+	/// </summary>
+	/// <returns>true=, false=s</returns>
+	static bool flush(const void* data, size_t size);
+
+	/// <summary>
+	/// <para>}bv[data, data+size)͈̔͂ɊSɊ܂܂y[W</para>
+	/// <para>ɐGꂽƂɃt@Cǂݍݒ̂ŁAWRITȄꍇ͒l͕ςȂ</para>
+	/// <para>COPYŏy[W̕ύX͎</para>
+	/// </summary>
+	static void evict(const void* data, size_t size);
+
+private:
+	/// <summary>
+	/// <para>Jt@CmodeŃ}bv</para>
+	/// </summary>
+	bool map(DataMapMode mode);
+
+	/// <returns>y[W̑傫</returns>
+	static size_t pageSize();
+
+private:
+#ifdef _WIN32
+	HANDLE m_file;
+	HANDLE m_mapping;
+#else
+	int m_file;
+#endif
+	char* m_data;
+	size_t m_size;
+	DataMapMode m_mode;
+};
+
+
+
+
+inline DataMappedFile::DataMappedFile()
+#ifdef _WIN32
+	: m_file(INVALID_HANDLE_VALUE)
+	, m_mapping()
+#else
+	: m_file(-1)
+#endif
+	, m_data()
+	, m_size()
+	, m_mode()
+{
+}
+
+inline DataMappedFile::~DataMappedFile()
+{
+	close();
+}
+
+inline bool DataMappedFile::open(const char* path, DataMapMode mode)
+{
+	close();
+
+#ifdef _WIN32
+	DWORD access = mode == DataMapMode::WRITE ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ;
+	DWORD share = mode == DataMapMode::WRITE ? FILE_SHARE_READ | FILE_SHARE_WRITE : FILE_SHARE_READ;
+	m_file = CreateFileA(path, access, share, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (m_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size = {};
+	if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+	{
+		close();
+		return false;
+	}
+	m_size = static_cast<size_t>(size.QuadPart);
+#else
+	m_file = ::open(path, mode == DataMapMode::WRITE ? O_RDWR : O_RDONLY);
+	if (m_file < 0)
+		return false;
+
+	struct stat st = {};
+	if (fstat(m_file, &st) != 0 || st.st_size == 0)
+	{
+		close();
+		return false;
+	}
+	m_size = static_cast<size_t>(st.st_size);
+#endif
+
+	return map(mode);
+}
+
+inline bool DataMappedFile::create(const char* path, size_t size)
+{
+	close();
+	if (size == 0)
+		return false;
+
+#ifdef _WIN32
+	m_file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (m_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	// t@C̑傫CreateFileMappingAōL
+#else
+	m_file = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (m_file < 0)
+		return false;
+
+	if (ftruncate(m_file, static_cast<off_t>(size)) != 0)
+	{
+		close();
+		return false;
+	}
+#endif
+
+	m_size = size;
+	return map(DataMapMode::WRITE);
+}
+
+inline bool DataMappedFile::map(DataMapMode mode)
+{
+	m_mode = mode;
+
+#ifdef _WIN32
+	DWORD protect = mode == DataMapMode::READ ? PAGE_READONLY : mode == DataMapMode::COPY ? PAGE_WRITECOPY : PAGE_READWRITE;
+	DWORD access = mode == DataMapMode::READ ? FILE_MAP_READ : mode == DataMapMode::COPY ? FILE_MAP_COPY : FILE_MAP_WRITE;
+	m_mapping = CreateFileMappingA(m_file, nullptr, protect, static_cast<DWORD>(static_cast<uint64_t>(m_size) >> 32), static_cast<DWORD>(m_size), nullptr);
+	if (!m_mapping)
+	{
+		close();
+		return false;
+	}
+
+	m_data = static_cast<char*>(MapViewOfFile(m_mapping, access, 0, 0, 0));
+#else
+	int protect = mode == DataMapMode::READ ? PROT_READ : PROT_READ | PROT_WRITE;
+	int flags = mode == DataMapMode::COPY ? MAP_PRIVATE : MAP_SHARED;
+	void* p = mmap(nullptr, m_size, protect, flags, m_file, 0);
+	m_data = p == MAP_FAILED ? nullptr : static_cast<char*>(p);
+#endif
+
+	if (!m_data)
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+inline void DataMappedFile::close()
+{
+#ifdef _WIN32
+	if (m_data)
+		UnmapViewOfFile(m_data);
+	if (m_mapping)
+		CloseHandle(m_mapping);
+	if (m_file != INVALID_HANDLE_VALUE)
+		CloseHandle(m_file);
+	m_file = INVALID_HANDLE_VALUE;
+	m_mapping = nullptr;
+#else
+	if (m_data)
+		munmap(m_data, m_size);
+	if (m_file >= 0)
+		::close(m_file);
+	m_file = -1;
+#endif
+	m_data = nullptr;
+	m_size = 0;
+	m_mode = DataMapMode::READ;
+}
+
+inline const char* DataMappedFile::data() const
+{
+	return m_data;
+}
+
+inline size_t DataMappedFile::size() const
+{
+	return m_size;
+}
+
+inline char* DataMappedFile::writableData() const
+{
+	return m_mode == DataMapMode::READ ? nullptr : m_data;
+}
+
+inline DataMapMode DataMappedFile::mode() const
+{
+	return m_mode;
+}
+
+inline void DataMappedFile::prefetch(size_t offset, size_t size) const
+{
+	if (!m_data || offset >= m_size)
+		return;
+	prefetch(m_data + offset, size < m_size - offset ? size : m_size - offset);
+}
+
+inline bool DataMappedFile::flush() const
+{
+	if (!m_data || m_mode != DataMapMode::WRITE)
+		return true;
+
+#ifdef _WIN32
+	// FlushViewOfFile͏on߂邾Ȃ̂ŁAt@C̃obt@ođ҂
+	return FlushViewOfFile(m_data, 0) != 0 && FlushFileBuffers(m_file) != 0;
+#else
+	return flush(m_data, m_size);
+#endif
+}
+
+inline void DataMappedFile::prefetch(const void* data, size_t size)
+{
+	if (size == 0)
+		return;
+
+#ifdef _WIN32
+#if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602
+	WIN32_MEMORY_RANGE_ENTRY range = {const_cast<void*>(data), size};
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+#else
+	// madvise̓y[WEn߂Kv
+	uintptr_t p = reinterpret_cast<uintptr_t>(data);
+	uintptr_t first = p / pageSize() * pageSize();
+	madvise(reinterpret_cast<void*>(first), p + size - first, MADV_WILLNEED);
+#endif
+}
+
+inline bool DataMappedFile::flush(const void* data, size_t size)
+{
+	if (size == 0)
+		return true;
+
+#ifdef _WIN32
+	return FlushViewOfFile(data, size) != 0;
+#else
+	uintptr_t p = reinterpret_cast<uintptr_t>(data);
+	uintptr_t first = p / pageSize() * pageSize();
+	return msync(reinterpret_cast<void*>(first), p + size - first, MS_SYNC) == 0;
+#endif
+}
+
+inline void DataMappedFile::evict(const void* data, size_t size)
+{
+	// ͈͊O̒l̂ĂȂ悤Ãy[WEɑ
+	uintptr_t p = reinterpret_cast<uintptr_t>(data);
+	uintptr_t first = (p + pageSize() - 1) / pageSize() * pageSize();
+	uintptr_t last = (p + size) / pageSize() * pageSize();
+	if (first >= last)
+		return;
+
+#ifdef _WIN32
+	// bNĂȂy[WVirtualUnlockĂԂƃ[LOZbgO
+	VirtualUnlock(reinterpret_cast<void*>(first), last - first);
+#else
+	madvise(reinterpret_cast<void*>(first), last - first, MADV_DONTNEED);
+#endif
+}
+
+inline size_t DataMappedFile::pageSize()
+{
+#ifdef _WIN32
+	SYSTEM_INFO info = {};
+	GetSystemInfo(&info);
+	return info.dwPageSize;
+#else
+	static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	return size;
+#endif
+}
@@ -0,0 +1,256 @@
+#pragma once
+
+#include "DataBox.h"
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <mbstring.h>
+
+/// <summary>
+/// <para>DataBox̃t@C̕Cӂ̑傫̒fЂŎ󂯎Ȃ͂NX</para>
+/// <para>fЂ̋EőSp^OElfĂĂ悢</para>
+/// <para>󂯎DataBox\zĂ̂ŁAǂݍ݂Ɖ͂sĐi߂</para>
+/// <para>obt@͉͓̂r̃^O܂͒l</para>
+/// <para>^O[/DataBoxName][/]̂ǂł悢</para>
+/// </summary>
+class DataParser
+{
+public:
+	/// <summary>
+	/// <para>͌ʂi[DataBoxݒ肷</para>
+	/// <para>͕͒ʂDataBoxɍ\zAfinish()Ƃbox̏Ԓlu</para>
+	/// <para>rŎsꍇbox͕ύXȂ</para>
+	/// </summary>
+	explicit DataParser(DataBox& box);
+
+	DataParser(const DataParser&) = delete;
+	DataParser& operator=(const DataParser&) = delete;
+
+public:
+	/// <summary>
+	/// <para>̒fЂ͂</para>
+	/// <para>ԈĂƗO</para>
+	/// </summary>
+	/// <param name="data">fЂ̐擪̃|C^</param>
+	/// <param name="size">fЂ̃oCg</param>
+	void feed(const char* data, size_t size);
+
+	/// <summary>
+	/// <para>SĂ̒fЂ󂯎Ƃʒm</para>
+	/// <para>^OlADataBoxĂȂΗO</para>
+	/// <para>ƃRXgN^Őݒ肵DataBoxɉ͌ʂ</para>
+	/// </summary>
+	void finish();
+
+	/// <returns>܂łɎ󂯎oCg</returns>
+	size_t position() const;
+
+private:
+	enum class State
+	{
+		TEXT,
+		ITEM_NAME,
+		ITEM_VALUE,
+		BOX_OPEN,
+		BOX_NAME,
+		BOX_CLOSE_NAME
+	};
+
+	void complete();
+	DataBox& current();
+	[[noreturn]] void error(const char* message) const;
+
+private:
+	DataBox& m_target;
+	DataBox m_root;
+	std::vector<DataBox> m_boxes;
+	std::vector<std::string> m_names;
+
+	State m_state;
+	bool m_trail;
+	std::string m_name;
+	std::string m_token;
+	size_t m_position;
+};
+
+
+
+
+inline DataParser::DataParser(DataBox& box)
+	: m_target(box)
+	, m_root()
+	, m_boxes()
+	, m_names()
+	, m_state(State::TEXT)
+	, m_trail()
+	, m_name()
+	, m_token()
+	, m_position()
+{
+}
+
+inline void DataParser::feed(const char* data, size_t size)
+{
+	FDA_TRACE_PHASE(DataTracePhase::SCAN);
+
+	const unsigned char* text = reinterpret_cast<const unsigned char*>(data);
+	size_t base = m_position;
+	size_t i = 0;
+	while (i < size)
+	{
+		// ^O̊O
+		if (m_state == State::TEXT)
+		{
+			for (; i < size; ++i)
+			{
+				// Sp͓ǂݔ΂
+				// 2oCgڂ̒fЂɂꍇ̂ŃtOŊoĂ
+				if (m_trail)
+				{
+					m_trail = false;
+					continue;
+				}
+				if (_mbclen(text + i) == 2)
+				{
+					m_trail = true;
+					continue;
+				}
+				if (text[i] == '(')
+				{
+					m_state = State::ITEM_NAME;
+					++i;
+					break;
+				}
+				if (text[i] == '[')
+				{
+					m_state = State::BOX_OPEN;
+					++i;
+					break;
+				}
+			}
+			continue;
+		}
+
+		// '['̎̕ŊJn^OI^O𔻒f
+		if (m_state == State::BOX_OPEN)
+		{
+			if (text[i] == '/')
+			{
+				m_state = State::BOX_CLOSE_NAME;
+				++i;
+			}
+			else
+			{
+				m_state = State::BOX_NAME;
+			}
+			continue;
+		}
+
+		// ^O܂͒l̏IT
+		char end = m_state == State::ITEM_NAME ? ')' : m_state == State::ITEM_VALUE ? '\n' : ']';
+		size_t start = i;
+		for (; i < size; ++i)
+		{
+			if (m_trail)
+			{
+				m_trail = false;
+				continue;
+			}
+			if (_mbclen(text + i) == 2)
+			{
+				m_trail = true;
+				continue;
+			}
+			if (text[i] == end)
+				break;
+		}
+		m_token.append(data + start, i - start);
+
+		// fЂ̍Ō܂ŏI肪ȂΑ̒fЂ҂
+		if (i == size)
+			break;
+
+		++i;
+		m_position = base + i;
+		complete();
+	}
+
+	m_position = base + size;
+}
+
+inline void DataParser::finish()
+{
+	// t@C̍Ō̒l͉sŏIĂȂĂ悢
+	if (m_state == State::ITEM_VALUE)
+		complete();
+
+	if (m_state != State::TEXT)
+		error("tag is not closed");
+	if (!m_boxes.empty())
+		error("box is not closed");
+
+	m_target = std::move(m_root);
+}
+
+inline size_t DataParser::position() const
+{
+	return m_position;
+}
+
+inline void DataParser::complete()
+{
+	switch (m_state)
+	{
+	case State::ITEM_NAME:
+		m_name.swap(m_token);
+		m_token.clear();
+		m_state = State::ITEM_VALUE;
+		return;
+
+	case State::ITEM_VALUE:
+	{
+		// sCRLF̏ꍇɔCR͎菜
+		if (!m_token.empty() && m_token.back() == '\r')
+			m_token.pop_back();
+
+		FDA_TRACE_PHASE(DataTracePhase::BUILD);
+		current().add(m_name, DataItem::createFromFormat(m_token.c_str()));
+	}
+	break;
+
+	case State::BOX_NAME:
+		m_names.emplace_back(m_token);
+		m_boxes.emplace_back();
+		break;
+
+	case State::BOX_CLOSE_NAME:
+	{
+		// OɊJDataBoxƖOvȂΗO ([/]͖OׂȂ)
+		if (m_boxes.empty() || (!m_token.empty() && m_names.back() != m_token))
+			error("unmatched closing tag");
+
+		FDA_TRACE_PHASE(DataTracePhase::BUILD);
+		DataBox box = std::move(m_boxes.back());
+		m_boxes.pop_back();
+		current().add(std::move(m_names.back()), std::move(box));
+		m_names.pop_back();
+	}
+	break;
+
+	default:
+		break;
+	}
+
+	m_token.clear();
+	m_state = State::TEXT;
+}
+
+inline DataBox& DataParser::current()
+{
+	return m_boxes.empty() ? m_root : m_boxes.back();
+}
+
+inline void DataParser::error(const char* message) const
+{
+	throw std::runtime_error(std::string("DataParser: ") + message + " at " + std::to_string(m_position));
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+#include "DataBox.h"
+#include <optional>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// <para>DataPatch̑̎</para>
+/// <para>SET_ITEM=DataItemǉ܂͏㏑</para>
+/// <para>REMOVE_ITEM=DataItem폜</para>
+/// <para>ADD_BOX=DataBoxǉ (݂ꍇ͒g폜)</para>
+/// <para>REMOVE_BOX=DataBox폜</para>
+/// </summary>
+enum class DataPatchType
+{
+	SET_ITEM,
+	REMOVE_ITEM,
+	ADD_BOX,
+	REMOVE_BOX
+};
+
+/// <summary>
+/// <para>2DataBox̍\NX</para>
+/// <para>̓nbVlقȂDataBoxHċ߂̂ŁAقƂǓؓmȂύXӏ̕Ȃ</para>
+/// <para>pX'/'؂</para>
+/// </summary>
+class DataPatch
+{
+public:
+	struct Operation
+	{
+		DataPatchType type;
+		std::string path;
+		std::optional<DataItem> item;
+	};
+
+public:
+	/// <summary>
+	/// <para>fromtoɕςŏ̍߂</para>
+	/// </summary>
+	static DataPatch diff(const DataBox& from, const DataBox& to);
+
+	/// <summary>
+	/// <para>Kp</para>
+	/// <para>rDataBox̃pX݂ȂꍇO</para>
+	/// </summary>
+	void apply(DataBox& box) const;
+
+	/// <returns>true=Ȃ</returns>
+	bool empty() const;
+
+	/// <returns>̈ꗗ</returns>
+	const std::vector<Operation>& operations() const;
+
+private:
+	void diff(const DataBox& from, const DataBox& to, const std::string& path);
+	void addAll(const DataBox& to, const std::string& path);
+	void push(DataPatchType type, const std::string& path, const DataItem* item = nullptr);
+
+private:
+	std::vector<Operation> m_operations;
+};
+
+
+
+
+inline DataPatch DataPatch::diff(const DataBox& from, const DataBox& to)
+{
+	DataPatch patch;
+	patch.diff(from, to, std::string());
+	return patch;
+}
+
+inline void DataPatch::apply(DataBox& box) const
+{
+	for (auto& o : m_operations)
+	{
+		// Ō̖O̐eDataBox܂ŒH
+		std::string_view path = o.path;
+		DataBox* parent = &box;
+		size_t s = 0;
+		for (size_t e = path.find('/'); e != std::string_view::npos; s = e + 1, e = path.find('/', s))
+			parent = &(*parent)[path.substr(s, e - s)];
+		std::string_view name = path.substr(s);
+
+		switch (o.type)
+		{
+		case DataPatchType::SET_ITEM:
+			parent->add(name, DataItem(*o.item));
+			break;
+		case DataPatchType::REMOVE_ITEM:
+			parent->removeItem(name);
+			break;
+		case DataPatchType::ADD_BOX:
+			parent->add(name, DataBox());
+			break;
+		case DataPatchType::REMOVE_BOX:
+			parent->removeBox(name);
+			break;
+		}
+	}
+}
+
+inline bool DataPatch::empty() const
+{
+	return m_operations.empty();
+}
+
+inline const std::vector<DataPatch::Operation>& DataPatch::operations() const
+{
+	return m_operations;
+}
+
+inline void DataPatch::diff(const DataBox& from, const DataBox& to, const std::string& path)
+{
+	// nbVlΒgHȂ
+	if (from.equals(to))
+		return;
+
+	// DataItem𖼑Oɓɑ
+	auto fi = from.items();
+	auto ti = to.items();
+	auto f = fi.begin();
+	auto t = ti.begin();
+	while (f != fi.end() || t != ti.end())
+	{
+		if (t == ti.end() || (f != fi.end() && f->first < t->first))
+		{
+			push(DataPatchType::REMOVE_ITEM, path + f->first);
+			++f;
+		}
+		else if (f == fi.end() || t->first < f->first)
+		{
+			push(DataPatchType::SET_ITEM, path + t->first, &t->second);
+			++t;
+		}
+		else
+		{
+			if (f->second.hash() != t->second.hash())
+				push(DataPatchType::SET_ITEM, path + t->first, &t->second);
+			++f;
+			++t;
+		}
+	}
+
+	// DataBoxlɑAɂ͍̂ċAIɔr
+	auto fb = from.boxes();
+	auto tb = to.boxes();
+	auto g = fb.begin();
+	auto u = tb.begin();
+	while (g != fb.end() || u != tb.end())
+	{
+		if (u == tb.end() || (g != fb.end() && g->first < u->first))
+		{
+			push(DataPatchType::REMOVE_BOX, path + g->first);
+			++g;
+		}
+		else if (g == fb.end() || u->first < g->first)
+		{
+			push(DataPatchType::ADD_BOX, path + u->first);
+			addAll(u->second, path + u->first + '/');
+			++u;
+		}
+		else
+		{
+			diff(g->second, u->second, path + u->first + '/');
+			++g;
+			++u;
+		}
+	}
+}
+
+inline void DataPatch::addAll(const DataBox& to, const std::string& path)
+{
+	for (auto& i : to.items())
+		push(DataPatchType::SET_ITEM, path + i.first, &i.second);
+
+	for (auto& i : to.boxes())
+	{
+		push(DataPatchType::ADD_BOX, path + i.first);
+		addAll(i.second, path + i.first + '/');
+	}
+}
+
+inline void DataPatch::push(DataPatchType type, const std::string& path, const DataItem* item)
+{
+	Operation o = {type, path, std::nullopt};
+	if (item)
+		o.item.emplace(*item);
+	m_operations.push_back(std::move(o));
+}
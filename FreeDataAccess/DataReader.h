@@ -0,0 +1,385 @@
+#pragma once
+
+#include "DataBox.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <stdexcept>
+#include <cstring>
+#include <mbstring.h>
+
+/// <summary>
+/// <para>DataReader::next()ԂCxg</para>
+/// <para>BOX_BEGIN=[DataBoxName]ǂ</para>
+/// <para>BOX_END=[/DataBoxName]܂[/]ǂ</para>
+/// <para>ITEM=(DataItemName)Valueǂ</para>
+/// <para>END=t@C̍ŌɓB</para>
+/// </summary>
+enum class DataReaderEvent
+{
+	BOX_BEGIN,
+	BOX_END,
+	ITEM,
+	END
+};
+
+/// <summary>
+/// <para>DataBox̃t@C擪珇ɃCxgƂēǂݏoNX</para>
+/// <para>DataBox̖؂Ȃ̂ŁAt@CTCYɊւ炸gpʂ</para>
+/// <para>obt@TCY(1̃^Ol蒷ꍇ͂̒)Ɠq̐[Ō܂</para>
+/// <para>name()value()Ԃ͎next()skipBox()ĂԂ܂ŗL</para>
+/// </summary>
+class DataReader
+{
+public:
+	/// <param name="bufferSize">t@Cǂݍރobt@̃TCY</param>
+	explicit DataReader(size_t bufferSize = 64 * 1024);
+
+	DataReader(const DataReader&) = delete;
+	DataReader& operator=(const DataReader&) = delete;
+
+public:
+	/// <summary>
+	/// <para>t@CJ</para>
+	/// <para>ɊJĂt@C͕</para>
+	/// </summary>
+	/// <param name="path">̓t@CpX</param>
+	/// <returns>true=, false=s</returns>
+	bool open(const char* path);
+
+	/// <summary>
+	/// <para>t@C</para>
+	/// </summary>
+	void close();
+
+	/// <summary>
+	/// <para>̃Cxg܂œǂݐi߂</para>
+	/// <para>t@C̏ԈĂƗO</para>
+	/// </summary>
+	DataReaderEvent next();
+
+	/// <summary>
+	/// <para>OBOX_BEGINɑΉBOX_END܂œǂݔ΂</para>
+	/// <para>gDataBoxDataItem͐Ȃ</para>
+	/// <para>ÕCxgBOX_BEGINłȂΗO</para>
+	/// </summary>
+	void skipBox();
+
+	/// <summary>
+	/// <para>OBOX_BEGINɑΉBOX_END܂œǂ݁AgDataBoxƂĐ</para>
+	/// <para>ÕCxgBOX_BEGINłȂΗO</para>
+	/// </summary>
+	DataBox readBox();
+
+	/// <summary>
+	/// <para>OITEM̒lDataItem𐶐</para>
+	/// <para>ÕCxgITEMłȂΗO</para>
+	/// </summary>
+	DataItem item() const;
+
+	/// <returns>
+	/// <para>ÕCxgDataBox܂DataItem</para>
+	/// <para>[/]ɂBOX_END̏ꍇ͋</para>
+	/// <para>kI[Ă</para>
+	/// </returns>
+	std::string_view name() const;
+
+	/// <returns>
+	/// <para>OITEM̒l</para>
+	/// <para>kI[Ă</para>
+	/// </returns>
+	std::string_view value() const;
+
+	/// <returns>݊JĂDataBox̓q̐[</returns>
+	size_t depth() const;
+
+private:
+	size_t find(size_t from, char sbc);
+	bool fill();
+	void pushName(std::string_view name);
+	void popName(std::string_view name);
+
+private:
+	std::ifstream m_file;
+	std::vector<char> m_buffer;
+	size_t m_pos;
+	size_t m_end;
+	bool m_eof;
+
+	DataReaderEvent m_event;
+	std::string_view m_name;
+	std::string_view m_value;
+
+	std::string m_names;
+	std::vector<size_t> m_nameEnds;
+};
+
+
+
+
+inline DataReader::DataReader(size_t bufferSize)
+	: m_file()
+	, m_buffer(bufferSize < 16 ? 17 : bufferSize + 1)
+	, m_pos()
+	, m_end()
+	, m_eof(true)
+	, m_event(DataReaderEvent::END)
+	, m_name()
+	, m_value()
+	, m_names()
+	, m_nameEnds()
+{
+}
+
+inline bool DataReader::open(const char* path)
+{
+	close();
+
+	m_file.open(path, std::ios::in);
+	if (!m_file)
+		return false;
+
+	m_eof = false;
+	return true;
+}
+
+inline void DataReader::close()
+{
+	if (m_file.is_open())
+		m_file.close();
+	m_file.clear();
+
+	m_pos = 0;
+	m_end = 0;
+	m_eof = true;
+	m_event = DataReaderEvent::END;
+	m_name = std::string_view();
+	m_value = std::string_view();
+	m_names.clear();
+	m_nameEnds.clear();
+}
+
+inline DataReaderEvent DataReader::next()
+{
+	m_name = std::string_view();
+	m_value = std::string_view();
+
+	while (true)
+	{
+		if (m_pos >= m_end && !fill())
+		{
+			// DataBoxOɃt@CIO
+			if (!m_nameEnds.empty())
+				throw std::runtime_error("DataReader: unexpected end of file");
+			return m_event = DataReaderEvent::END;
+		}
+
+		// Sp͓ǂݔ΂
+		if (_mbclen(reinterpret_cast<const unsigned char*>(&m_buffer[m_pos])) == 2)
+		{
+			if (m_pos + 1 >= m_end)
+				fill();
+			m_pos += 2;
+			continue;
+		}
+
+		char c = m_buffer[m_pos];
+
+		// DataItem̃^OƂ
+		if (c == '(')
+		{
+			// ̏
+			// 0            j     k
+			// (DataItemName)Value
+			size_t j = find(1, ')');
+			if (j == std::string::npos)
+				throw std::runtime_error("DataReader: ')' not found");
+			size_t k = find(j + 1, '\n');
+
+			// lt@C̍ŌŏIĂꍇ͉s̑Ƀobt@̗\1oCgg
+			if (k == std::string::npos)
+				k = m_end - m_pos;
+
+			// ^OƉskɂĂ̂܂DataItem::createFromFormat()ɓn悤ɂ
+			char* p = &m_buffer[m_pos];
+			p[j] = '\0';
+			p[k] = '\0';
+			m_name = std::string_view(p + 1, j - 1);
+			m_value = std::string_view(p + j + 1, k - j - 1);
+			m_pos += k + 1;
+			return m_event = DataReaderEvent::ITEM;
+		}
+
+		// DataBox̃^OƂ
+		if (c == '[')
+		{
+			if (m_pos + 1 >= m_end && !fill())
+				throw std::runtime_error("DataReader: unexpected end of file");
+
+			bool end = m_buffer[m_pos + 1] == '/';
+			size_t s = end ? 2 : 1;
+			size_t j = find(s, ']');
+			if (j == std::string::npos)
+				throw std::runtime_error("DataReader: ']' not found");
+
+			char* p = &m_buffer[m_pos];
+			p[j] = '\0';
+			m_name = std::string_view(p + s, j - s);
+			m_pos += j + 1;
+
+			if (end)
+			{
+				popName(m_name);
+				return m_event = DataReaderEvent::BOX_END;
+			}
+			pushName(m_name);
+			return m_event = DataReaderEvent::BOX_BEGIN;
+		}
+
+		++m_pos;
+	}
+}
+
+inline void DataReader::skipBox()
+{
+	if (m_event != DataReaderEvent::BOX_BEGIN)
+		throw std::logic_error("DataReader: skipBox() requires BOX_BEGIN");
+
+	size_t d = depth();
+	while (depth() >= d)
+	{
+		if (next() == DataReaderEvent::END)
+			throw std::runtime_error("DataReader: unexpected end of file");
+	}
+}
+
+inline DataBox DataReader::readBox()
+{
+	if (m_event != DataReaderEvent::BOX_BEGIN)
+		throw std::logic_error("DataReader: readBox() requires BOX_BEGIN");
+
+	DataBox box;
+	size_t d = depth();
+	while (true)
+	{
+		switch (next())
+		{
+		case DataReaderEvent::ITEM:
+			box.add(m_name, item());
+			break;
+		case DataReaderEvent::BOX_BEGIN:
+		{
+			// gǂނm_name͖ɂȂ̂ŐɑޔĂ
+			std::string name(m_name);
+			DataBox child = readBox();
+			box.add(std::move(name), std::move(child));
+		}
+		break;
+		case DataReaderEvent::BOX_END:
+			if (depth() < d)
+				return box;
+			break;
+		case DataReaderEvent::END:
+			throw std::runtime_error("DataReader: unexpected end of file");
+		}
+	}
+}
+
+inline DataItem DataReader::item() const
+{
+	if (m_event != DataReaderEvent::ITEM)
+		throw std::logic_error("DataReader: item() requires ITEM");
+
+	return DataItem::createFromFormat(m_value.data());
+}
+
+inline std::string_view DataReader::name() const
+{
+	return m_name;
+}
+
+inline std::string_view DataReader::value() const
+{
+	return m_value;
+}
+
+inline size_t DataReader::depth() const
+{
+	return m_nameEnds.size();
+}
+
+inline size_t DataReader::find(size_t from, char sbc)
+{
+	// Spǂݔ΂Ȃm_pos̑ΈʒuŔpT
+	// OɃt@CInposԂ
+	size_t i = from;
+	while (true)
+	{
+		if (m_pos + i >= m_end && !fill())
+			return std::string::npos;
+
+		if (_mbclen(reinterpret_cast<const unsigned char*>(&m_buffer[m_pos + i])) == 2)
+		{
+			if (m_pos + i + 1 >= m_end && !fill())
+				return std::string::npos;
+			i += 2;
+			continue;
+		}
+		if (m_buffer[m_pos + i] == sbc)
+			return i;
+		++i;
+	}
+}
+
+inline bool DataReader::fill()
+{
+	if (m_eof)
+		return false;
+
+	FDA_TRACE_PHASE(DataTracePhase::READ);
+
+	// ǂ݂̃g[Nobt@̐擪Ɋ񂹂
+	size_t rest = m_end - m_pos;
+	if (m_pos > 0)
+	{
+		if (rest > 0)
+			memmove(m_buffer.data(), m_buffer.data() + m_pos, rest);
+		m_pos = 0;
+		m_end = rest;
+	}
+
+	// 1̃g[Nobt@蒷ꍇobt@L
+	// Ō1oCg̓kI[p̗\
+	if (m_end >= m_buffer.size() - 1)
+		m_buffer.resize((m_buffer.size() - 1) * 2 + 1);
+
+	m_file.read(m_buffer.data() + m_end, m_buffer.size() - 1 - m_end);
+	size_t n = static_cast<size_t>(m_file.gcount());
+	m_end += n;
+	if (n == 0)
+		m_eof = true;
+
+	return n > 0;
+}
+
+inline void DataReader::pushName(std::string_view name)
+{
+	m_names.append(name);
+	m_nameEnds.push_back(m_names.size());
+}
+
+inline void DataReader::popName(std::string_view name)
+{
+	// JĂDataBoxƖOvȂΗO ([/]͖OׂȂ)
+	if (m_nameEnds.empty())
+		throw std::runtime_error("DataReader: unmatched closing tag");
+
+	size_t e = m_nameEnds.back();
+	size_t s = m_nameEnds.size() >= 2 ? m_nameEnds[m_nameEnds.size() - 2] : 0;
+	if (!name.empty() && std::string_view(m_names).substr(s, e - s) != name)
+		throw std::runtime_error("DataReader: unmatched closing tag");
+
+	m_names.resize(s);
+	m_nameEnds.pop_back();
+}
@@ -0,0 +1,307 @@
+#pragma once
+
+#include "DataBox.h"
+#include <array>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/// <summary>
+/// <para>\̂̃oDataBox̃pX̑Ήx錾A܂Ƃ߂ēǂݏNX</para>
+/// <para>pX'/'؂ŁAŌオDataItemAȊODataBox</para>
+/// <para>ǂݏDataBoxƂɖO1񑖍邾ŁAoƂɌȂ</para>
+/// <para>ǒ^͎Zp^Estd::stringEstd::arrayEŒ蒷zEstd::vectorɑΉAȊO̓RpCG[</para>
+/// <code>
+/// static const auto schema = DataSchema&lt;Grape&gt;()
+///     .field("Â", &amp;Grape::sweetness)
+///     .field("/", &amp;Grape::deliciousness);
+/// schema.load(box, grape);
+/// </code>
+/// </summary>
+template<typename T>
+class DataSchema
+{
+public:
+	DataSchema();
+
+	DataSchema(DataSchema&&) noexcept = default;
+	DataSchema& operator=(DataSchema&&) noexcept = default;
+
+public:
+	/// <summary>
+	/// <para>oƃpX̑Ήǉ</para>
+	/// <para>pX2ǉƗO</para>
+	/// </summary>
+	/// <param name="path">DataBoxName/.../DataItemName</param>
+	/// <param name="member">oւ̃|C^</param>
+	template<typename M>
+	DataSchema&& field(const char* path, M T::* member) &&;
+
+	template<typename M>
+	DataSchema& field(const char* path, M T::* member) &;
+
+	/// <summary>
+	/// <para>DataBox\̂֓ǂݍ</para>
+	/// <para>pX݂ȂꍇA^̃TCYvfvȂꍇO</para>
+	/// </summary>
+	void load(const DataBox& box, T& value) const;
+
+	/// <summary>
+	/// <para>\̂DataBox֏</para>
+	/// <para>pX݂Ȃꍇ͒ǉA݂ꍇ͌^񂲂Ə㏑</para>
+	/// </summary>
+	void store(const T& value, DataBox& box) const;
+
+private:
+	struct Field
+	{
+		virtual ~Field() = default;
+		virtual void load(const DataItem& item, T& value) const = 0;
+		virtual DataItem store(const T& value) const = 0;
+	};
+
+	template<typename M>
+	struct MemberField : Field
+	{
+		M T::* member;
+
+		explicit MemberField(M T::* m) : member(m) {}
+		void load(const DataItem& item, T& value) const override;
+		DataItem store(const T& value) const override;
+	};
+
+	struct Node
+	{
+		// ǂOɕׂĂADataBoxstd::mapƓɑ
+		std::vector<std::pair<std::string, std::unique_ptr<Field>>> items;
+		std::vector<std::pair<std::string, Node>> boxes;
+	};
+
+	template<typename E>
+	static constexpr bool isElement();
+
+	static void check(const DataItem& item, size_t elementSize, size_t elementCount);
+	static void load(const Node& node, const DataBox& box, T& value);
+	static void store(const Node& node, const T& value, DataBox& box);
+
+private:
+	Node m_root;
+};
+
+
+
+
+template<typename T>
+inline DataSchema<T>::DataSchema()
+	: m_root()
+{
+}
+
+template<typename T>
+template<typename M>
+inline DataSchema<T>&& DataSchema<T>::field(const char* path, M T::* member) &&
+{
+	return std::move(field(path, member));
+}
+
+template<typename T>
+template<typename M>
+inline DataSchema<T>& DataSchema<T>::field(const char* path, M T::* member) &
+{
+	if constexpr (std::is_same_v<M, std::string>)
+	{
+	}
+	else if constexpr (std::is_array_v<M>)
+	{
+		static_assert(std::rank_v<M> == 1 && isElement<std::remove_extent_t<M>>(), "ΉĂȂž^");
+	}
+	else if constexpr (std::is_class_v<M>)
+	{
+		static_assert(isElement<typename M::value_type>()
+			&& ((std::is_same_v<M, std::vector<typename M::value_type>> && !std::is_same_v<M, std::vector<bool>>)
+				|| std::is_same_v<M, std::array<typename M::value_type, sizeof(M) / sizeof(typename M::value_type)>>), "ΉĂȂǒ^");
+	}
+	else
+	{
+		static_assert(isElement<M>(), "ΉĂȂǒ^");
+	}
+
+	// pX'/'ŋ؂DataBoxHAŌ̖ODataItemƂĖÖʒuɑ}
+	Node* node = &m_root;
+	std::string p(path);
+	size_t s = 0;
+	for (size_t e = p.find('/'); e != std::string::npos; s = e + 1, e = p.find('/', s))
+	{
+		std::string name = p.substr(s, e - s);
+		auto i = node->boxes.begin();
+		while (i != node->boxes.end() && i->first < name)
+			++i;
+		if (i == node->boxes.end() || i->first != name)
+			i = node->boxes.emplace(i, std::move(name), Node());
+		node = &i->second;
+	}
+
+	std::string name = p.substr(s);
+	auto i = node->items.begin();
+	while (i != node->items.end() && i->first < name)
+		++i;
+	if (i != node->items.end() && i->first == name)
+		throw std::invalid_argument("DataSchema: duplicate path " + p);
+	node->items.emplace(i, std::move(name), std::make_unique<MemberField<M>>(member));
+
+	return *this;
+}
+
+template<typename T>
+inline void DataSchema<T>::load(const DataBox& box, T& value) const
+{
+	load(m_root, box, value);
+}
+
+template<typename T>
+inline void DataSchema<T>::store(const T& value, DataBox& box) const
+{
+	store(m_root, value, box);
+}
+
+template<typename T>
+template<typename M>
+inline void DataSchema<T>::MemberField<M>::load(const DataItem& item, T& value) const
+{
+	M& m = value.*member;
+	if constexpr (std::is_same_v<M, std::string>)
+	{
+		// kI[ƂĕێĂ邱
+		const char* text = static_cast<const char*>(item.getElementPointer());
+		if (item.getElementSize() != sizeof(char) || item.getElementCount() == 0 || text[item.getElementCount() - 1] != '\0')
+			throw std::runtime_error("DataSchema: item is not a string");
+		m.assign(text, item.getElementCount() - 1);
+	}
+	else if constexpr (std::is_array_v<M> || std::is_class_v<M>)
+	{
+		using E = std::remove_reference_t<decltype(m[0])>;
+		if constexpr (std::is_array_v<M> || std::is_same_v<M, std::array<E, sizeof(M) / sizeof(E)>>)
+		{
+			check(item, std::alignment_of_v<E>, std::size(m));
+		}
+		else
+		{
+			// złȂDataItem͎󂯕tȂ (store()vf0vectoroȂ)
+			if (item.getElementCount() == 0)
+				throw std::runtime_error("DataSchema: type mismatch");
+			check(item, std::alignment_of_v<E>, item.getElementCount());
+			m.resize(item.getElementCount());
+		}
+		size_t c = std::size(m);
+		memcpy(std::data(m), item.getElementPointer(), sizeof(E) * c);
+	}
+	else
+	{
+		check(item, std::alignment_of_v<M>, 0);
+		m = *static_cast<const M*>(item.getElementPointer());
+	}
+}
+
+template<typename T>
+template<typename M>
+inline DataItem DataSchema<T>::MemberField<M>::store(const T& value) const
+{
+	const M& m = value.*member;
+	if constexpr (std::is_same_v<M, std::string>)
+	{
+		return DataItem(m.c_str());
+	}
+	else if constexpr (std::is_array_v<M> || std::is_class_v<M>)
+	{
+		// vf0̔zDataItemŕ\łȂ
+		if (std::size(m) == 0)
+			throw std::invalid_argument("DataSchema: empty array");
+		return DataItem(std::data(m), std::size(m));
+	}
+	else
+	{
+		return DataItem(m);
+	}
+}
+
+template<typename T>
+template<typename E>
+inline constexpr bool DataSchema<T>::isElement()
+{
+	return std::is_arithmetic_v<E> && sizeof(E) <= 8;
+}
+
+template<typename T>
+inline void DataSchema<T>::check(const DataItem& item, size_t elementSize, size_t elementCount)
+{
+	if (item.getElementSize() != elementSize || item.getElementCount() != elementCount)
+		throw std::runtime_error("DataSchema: type mismatch");
+}
+
+template<typename T>
+inline void DataSchema<T>::load(const Node& node, const DataBox& box, T& value)
+{
+	// DataItemƃXL[}𖼑Oɓɑ
+	auto& items = box.m_item;
+	auto i = items.begin();
+	for (auto& f : node.items)
+	{
+		while (i != items.end() && i->first < f.first)
+			++i;
+		if (i == items.end() || i->first != f.first)
+			throw std::out_of_range("DataSchema: item not found " + f.first);
+		f.second->load(i->second, value);
+	}
+
+	// DataBoxlɑAċAIɓǂݍ
+	auto& boxes = box.m_box;
+	auto j = boxes.begin();
+	for (auto& n : node.boxes)
+	{
+		while (j != boxes.end() && j->first < n.first)
+			++j;
+		if (j == boxes.end() || j->first != n.first)
+			throw std::out_of_range("DataSchema: box not found " + n.first);
+		load(n.second, j->second, value);
+	}
+}
+
+template<typename T>
+inline void DataSchema<T>::store(const Node& node, const T& value, DataBox& box)
+{
+	// Ȃʒuqgɂđ}̂ŁA݂Ȃꍇ1ōς
+	auto& items = box.m_item;
+	auto i = items.begin();
+	for (auto& f : node.items)
+	{
+		while (i != items.end() && i->first < f.first)
+			++i;
+		if (i != items.end() && i->first == f.first)
+			i->second = f.second->store(value);
+		else
+		{
+			box.beforeChange(DataChange::BOX);
+			i = items.emplace_hint(i, f.first, f.second->store(value));
+			box.adopt(i->second);
+		}
+	}
+
+	auto& boxes = box.m_box;
+	auto j = boxes.begin();
+	for (auto& n : node.boxes)
+	{
+		while (j != boxes.end() && j->first < n.first)
+			++j;
+		if (j == boxes.end() || j->first != n.first)
+		{
+			box.beforeChange(DataChange::BOX);
+			j = boxes.emplace_hint(j, n.first, DataBox());
+			box.adopt(j->second);
+		}
+		store(n.second, value, j->second);
+	}
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+// Wv^ϊŎgSIMD߂RpC̐ݒőI
+// FDA_SIMD_AVX2=AVX2, FDA_SIMD_SSE2=SSE2, ǂ`Ȃꍇ1vf
+// FREEDATAACCESS_NO_SIMD`SIMD߂gȂ
+#ifndef FREEDATAACCESS_NO_SIMD
+#if defined(__AVX2__)
+#define FDA_SIMD_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FDA_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+#endif
@@ -0,0 +1,292 @@
+#pragma once
+
+#include "DataBox.h"
+#include "DataThreadPool.h"
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// <para>ύX~߂DataBox̂鎞_̏Ԃt@Cɕۑ֐Q</para>
+/// <para>ۑn߂ɕύXDataBox́AύX̒Oɂ̊Kw̏Ԃ𕡐 (Rs[ICg)</para>
+/// <para>ύX鑤~܂̂́A߂ĕύXDataBox̎q̐ɔႷ鎞Ԃ</para>
+/// <para>gւEjDataBox́A܂łȂqƕ</para>
+/// <para>݂͈ꎞt@CɍsAĂ疼OύX̂ŁAȑԂ̃t@C͎cȂ</para>
+/// <para>LXgœ|C^oȐ͌młȂ̂ŁAlۑ邱Ƃ</para>
+/// <para>ۑɑΏۂDataBox̂jEړȂ</para>
+/// <para>ύX̒O̕noexcept̃[uŝŗOOɏoA肸łȂꍇ͕ۑs</para>
+/// </summary>
+class DataSnapshot
+{
+public:
+	/// <summary>
+	/// <para>݂̏Ԃ񓯊ɕۑ</para>
+	/// <para>Ăяo͂ɖ߂Â܂ܕύX𑱂Ă悢</para>
+	/// </summary>
+	/// <param name="box">ۑDataBox</param>
+	/// <param name="path">t@CpX</param>
+	/// <param name="pool">gpXbhv[</param>
+	/// <returns>true=, false=t@C߂ȂEύXȌԂ𕡐łȂ</returns>
+	static std::future<bool> save(const DataBox& box, const char* path, DataThreadPool& pool = DataThreadPool::shared());
+
+private:
+	/// <summary>
+	/// <para>1DataBox̕ۑ_̏</para>
+	/// <para>text͏DataItem̍s, boxes͎qDataBox̖OƃAhX</para>
+	/// <para>finished=q܂ŏݍς</para>
+	/// </summary>
+	struct Level
+	{
+		std::string text;
+		std::vector<std::pair<std::string, const DataBox*>> boxes;
+		bool finished;
+	};
+
+	/// <summary>
+	/// <para>failed=ύXȌԂ𕡐łȂ̂ŁAȍ~͏܂Ȃ</para>
+	/// </summary>
+	struct State
+	{
+		const DataBox* root;
+		std::mutex mutex;
+		std::unordered_map<const DataBox*, Level> levels;
+		bool failed;
+	};
+
+	static void onChange(DataHashNode* node, DataChange change) noexcept;
+	static Level& capture(State& state, const DataBox* box, size_t depth);
+	static void captureSubtree(State& state, const DataBox* box, size_t depth);
+	template<typename Flush>
+	static void write(State& state, const DataBox* box, size_t depth, std::string& text, Flush& flush);
+	static void finish(const std::shared_ptr<State>& state);
+
+private:
+	static std::mutex ms_mutex;
+	static std::vector<std::shared_ptr<State>> ms_states;
+};
+
+
+
+
+inline std::mutex DataSnapshot::ms_mutex;
+inline std::vector<std::shared_ptr<DataSnapshot::State>> DataSnapshot::ms_states;
+
+inline std::future<bool> DataSnapshot::save(const DataBox& box, const char* path, DataThreadPool& pool)
+{
+	auto promise = std::make_shared<std::promise<bool>>();
+	auto future = promise->get_future();
+
+	// o^_ȍ~̕ύX͑SătbNŕ߂܂
+	auto state = std::make_shared<State>();
+	state->root = &box;
+	state->failed = false;
+	{
+		std::lock_guard<std::mutex> lock(ms_mutex);
+		ms_states.push_back(state);
+		DataHashNode::setChangeHook(&DataSnapshot::onChange);
+	}
+
+	pool.post([state, file = std::string(path), promise]()
+	{
+		std::string temp = file + ".tmp";
+		try
+		{
+			bool result = false;
+			{
+				std::ofstream o(temp, std::ios::out);
+				if (o)
+				{
+					std::string text;
+					auto flush = [&o](std::string& t)
+					{
+						if (t.size() >= (1 << 20))
+						{
+							FDA_TRACE_PHASE(DataTracePhase::WRITE);
+							o.write(t.data(), t.size());
+							t.clear();
+						}
+					};
+					{
+						FDA_TRACE_PHASE(DataTracePhase::FORMAT);
+						write(*state, state->root, 0, text, flush);
+					}
+					{
+						FDA_TRACE_PHASE(DataTracePhase::WRITE);
+						o.write(text.data(), text.size());
+					}
+					o.close();
+					std::lock_guard<std::mutex> lock(state->mutex);
+					result = !o.fail() && !state->failed;
+				}
+			}
+
+			std::error_code e;
+			if (result)
+				std::filesystem::rename(temp, file, e);
+			if (!result || e)
+			{
+				std::filesystem::remove(temp, e);
+				result = false;
+			}
+
+			finish(state);
+			promise->set_value(result);
+		}
+		catch (...)
+		{
+			finish(state);
+			promise->set_exception(std::current_exception());
+		}
+	});
+
+	return future;
+}
+
+inline void DataSnapshot::onChange(DataHashNode* node, DataChange change) noexcept
+{
+	// DataItem̕ύX͂DataBox̊Kw̕ύXƂĈ
+	const DataBox* box = change == DataChange::ITEM
+		? static_cast<const DataBox*>(node->m_hashParent)
+		: static_cast<const DataBox*>(node);
+	if (!box)
+		return;
+
+	std::lock_guard<std::mutex> lock(ms_mutex);
+	for (auto& s : ms_states)
+	{
+		// ۑDataBox̎qǂcHĒׂ
+		size_t depth = 0;
+		const DataHashNode* n = box;
+		while (n && n != s->root)
+		{
+			n = n->m_hashParent;
+			++depth;
+		}
+		if (!n)
+			continue;
+
+		// ݍς݂DataBox̎qȂ畡ȂĂ悢
+		std::lock_guard<std::mutex> stateLock(s->mutex);
+		bool finished = false;
+		for (const DataHashNode* m = box; m && !finished; m = m == s->root ? nullptr : m->m_hashParent)
+		{
+			auto i = s->levels.find(static_cast<const DataBox*>(m));
+			finished = i != s->levels.end() && i->second.finished;
+		}
+		if (finished)
+			continue;
+
+		if (s->failed)
+			continue;
+
+		// [uȂnoexcept̊֐Ă΂̂ŁAɎsO𓊂ɂ̕ۑs
+		try
+		{
+			if (change == DataChange::SUBTREE)
+				captureSubtree(*s, box, depth);
+			else
+				capture(*s, box, depth);
+		}
+		catch (...)
+		{
+			s->failed = true;
+		}
+	}
+}
+
+inline DataSnapshot::Level& DataSnapshot::capture(State& state, const DataBox* box, size_t depth)
+{
+	// state.mutexbNԂŌĂԂ
+	auto i = state.levels.find(box);
+	if (i != state.levels.end())
+		return i->second;
+
+	// DataItem̃LbV͕ύX鑤̃XbĥŎg킸ɏ
+	Level& level = state.levels[box];
+	level.finished = false;
+	std::string indent(depth * 2, ' ');
+	for (auto& j : box->m_item)
+	{
+		const DataItem& item = j.second;
+		level.text += indent;
+		level.text += '(';
+		level.text += j.first;
+		level.text += ')';
+		DataItem::appendFormat(level.text, item.getFormat(), item.getElementSize(), item.getElementCount(), item.getElementPointer());
+		level.text += '\n';
+	}
+	level.boxes.reserve(box->m_box.size());
+	for (auto& j : box->m_box)
+		level.boxes.emplace_back(j.first, &j.second);
+	return level;
+}
+
+inline void DataSnapshot::captureSubtree(State& state, const DataBox* box, size_t depth)
+{
+	// state.mutexbNԂŌĂԂ
+	// ς݂̊Kw͕ۑ_̎qH
+	Level& level = capture(state, box, depth);
+	if (level.finished)
+		return;
+	for (auto& i : level.boxes)
+		captureSubtree(state, i.second, depth + 1);
+}
+
+template<typename Flush>
+inline void DataSnapshot::write(State& state, const DataBox* box, size_t depth, std::string& text, Flush& flush)
+{
+	// ĂȂ΂ŕAȍ~͕ύX鑤ɕȂ
+	std::vector<std::pair<std::string, const DataBox*>> boxes;
+	{
+		// ɎśAύXDataBoxǂ܂Ȃ悤Ĥ߂
+		std::lock_guard<std::mutex> lock(state.mutex);
+		if (state.failed)
+			return;
+		Level& level = capture(state, box, depth);
+		text += level.text;
+		level.text = std::string();
+		boxes = level.boxes;
+	}
+	flush(text);
+
+	std::string indent(depth * 2, ' ');
+	for (auto& i : boxes)
+	{
+		text += indent;
+		text += '[';
+		text += i.first;
+		text += "]\n";
+		write(state, i.second, depth + 1, text, flush);
+		text += indent;
+		text += "[/";
+		text += i.first;
+		text += "]\n";
+		flush(text);
+	}
+
+	// q܂ŏ񂾂̂ŁÅKw̏͂vȂ
+	std::lock_guard<std::mutex> lock(state.mutex);
+	Level& level = state.levels[box];
+	level.boxes = std::vector<std::pair<std::string, const DataBox*>>();
+	level.finished = true;
+}
+
+inline void DataSnapshot::finish(const std::shared_ptr<State>& state)
+{
+	std::lock_guard<std::mutex> lock(ms_mutex);
+	for (auto i = ms_states.begin(); i != ms_states.end(); ++i)
+	{
+		if (*i == state)
+		{
+			ms_states.erase(i);
+			break;
+		}
+	}
+	if (ms_states.empty())
+		DataHashNode::setChangeHook(nullptr);
+}
@@ -0,0 +1,526 @@
+#pragma once
+
+#include "DataBox.h"
+#include "DataThreadPool.h"
+#include <deque>
+#include <fstream>
+#include <future>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// <summary>
+/// <para>DataSplitFile::inputFile()ŕt@Cǂݍގ</para>
+/// <para>PARALLEL=ŏʂ̃t@Cǂݍ񂾌At@CXbhv[ŕsēǂݍ</para>
+/// <para>DEFERRED=t@C͓ǂݍ܂ADataSplitFile::resolve()Ă񂾂Ƃɓǂݍ</para>
+/// </summary>
+enum class DataSplitLoad
+{
+	PARALLEL,
+	DEFERRED
+};
+
+/// <summary>
+/// <para>DataBoẍꕔ̎qDataBoxʂ̃t@Cɕēo͂NX</para>
+/// <para>DataBox͐ẽt@C (@include)"t@CpX" DataBoxƂďo</para>
+/// <para>̍s͒ʏDataItemȂ̂ŁAt@CDataBox::inputFile()Ȃǂł̂܂ܓǂ߂</para>
+/// <para>oƂ́AO̓o͂nbVlςDataBox̃t@C</para>
+/// <para>t@C̃pX́AqɂȂĂꍇŏʂ̃t@C̑΃pXŏ</para>
+/// <para>DataBox͍ŏʂDataBox̕тŎ</para>
+/// <para>ǂݍނƂ (@include) DataItemDataBoxSĕt@CƂĈ̂ŁA̖O𑼂̗prɎgȂ</para>
+/// <para>ǂݍ񂾃t@Cɏꂽ΃pX..܂ރpX͎󂯕tȂ (split()œo^pX͐΃pXł悢)</para>
+/// </summary>
+class DataSplitFile
+{
+public:
+	DataSplitFile();
+
+	DataSplitFile(const DataSplitFile&) = delete;
+	DataSplitFile& operator=(const DataSplitFile&) = delete;
+
+public:
+	/// <summary>
+	/// <para>pathDataBoxʂ̃t@Cɕďo悤o^</para>
+	/// <para>ɓo^Ăꍇ̓t@CpXύX</para>
+	/// <para>path̏ꍇO</para>
+	/// </summary>
+	/// <param name="path">ŏʂDataBox̕</param>
+	/// <param name="file">t@C̃pX (ŏʂ̃t@C̑΃pX)</param>
+	void split(const std::vector<std::string>& path, const std::string& file);
+
+	/// <summary>
+	/// <para>ďo悤o^DataBox𒲂ׂ</para>
+	/// </summary>
+	/// <returns>t@C̃pX, nullptr=o^ĂȂ</returns>
+	const std::string* file(const std::vector<std::string>& path) const;
+
+	/// <summary>
+	/// <para>DataBoxŏʂ̃t@Cƕt@C֏o͂</para>
+	/// <para>ŏʂ̃t@C͏񂪑OƕςꍇAt@C̓nbVlƏ񂪑Oƕςꍇ</para>
+	/// <para>inputFile()Eresolve()œǂݍ񂾃t@ĆȀo͂ŏ񂪓ǂݍ񂾓eƕςꍇ</para>
+	/// <para>DEFERREDł܂ǂݍłȂt@C͏܂Ȃ̂ŁADataBox͕ύXAʂ̃pX֏o͂Oresolve()Ă</para>
+	/// </summary>
+	/// <param name="box">o͂DataBox</param>
+	/// <param name="path">ŏʂ̃t@CpX</param>
+	/// <param name="style">o͂̏</param>
+	/// <returns>true=, false=߂Ȃt@C</returns>
+	bool outputFile(const DataBox& box, const char* path, DataOutputStyle style = DataOutputStyle::INDENTED);
+
+	/// <summary>
+	/// <para>ŏʂ̃t@Cǂݍ݁A(@include)DataBox𕪂t@C̒gŒu</para>
+	/// <para>(@include)͕ďo悤o^</para>
+	/// <para>SẴt@Cǂݍ߂ꍇbox̒gu</para>
+	/// <para>t@C̏ԈĂA(@include)̃pX΃pX..܂ނƗO</para>
+	/// </summary>
+	/// <param name="box">ǂݍݐ</param>
+	/// <param name="path">ŏʂ̃t@CpX</param>
+	/// <param name="load">t@Cǂݍގ</param>
+	/// <param name="pool">gpXbhv[</param>
+	/// <returns>true=, false=JȂt@C</returns>
+	bool inputFile(DataBox& box, const char* path, DataSplitLoad load = DataSplitLoad::PARALLEL, DataThreadPool& pool = DataThreadPool::shared());
+
+	/// <summary>
+	/// <para>DEFERREDœǂݍ܂ȂpathDataBox𕪂t@C̒gŒu</para>
+	/// <para>̒(@include)sēǂݍ</para>
+	/// <para>ɓǂݍłꍇ͉Ȃ</para>
+	/// <para>t@C̏ԈĂA(@include)̃pX΃pX..܂ނƗO</para>
+	/// </summary>
+	/// <param name="box">inputFile()œǂݍ񂾍ŏʂDataBox</param>
+	/// <param name="path">ŏʂDataBox̕</param>
+	/// <param name="pool">gpXbhv[</param>
+	/// <returns>true=, false=o^ĂȂEJȂt@C</returns>
+	bool resolve(DataBox& box, const std::vector<std::string>& path, DataThreadPool& pool = DataThreadPool::shared());
+
+	/// <returns>OoutputFile()ŏ񂾃t@C̐</returns>
+	size_t written() const;
+
+	/// <summary>
+	/// <para>DataBox̑ɏoDataItem̖O</para>
+	/// </summary>
+	static constexpr const char* INCLUDE = "@include";
+
+private:
+	/// <summary>
+	/// <para>t@C1̏</para>
+	/// </summary>
+	struct Entry
+	{
+		std::string file;
+		std::optional<uint64_t> hash;
+		uint64_t textHash;
+		bool loaded;
+		bool written;
+	};
+
+	/// <summary>
+	/// <para>ǂݍ񂾃t@C1̓e</para>
+	/// </summary>
+	struct Content
+	{
+		DataBox box;
+		uint64_t textHash;
+	};
+
+	using Path = std::vector<std::string>;
+	using Splits = std::map<const DataBox*, Entry*>;
+
+	/// <summary>
+	/// <para>pendingDataBox𕪂t@C̒gŒuA̒(@include)ēǂݍ</para>
+	/// <para>SẴt@Cǂݍ߂ꍇrootύX</para>
+	/// </summary>
+	bool load(DataBox& root, std::vector<Path>&& pending, DataThreadPool& pool);
+
+	/// <returns>root̒ŕďoDataBoxƂ̏</returns>
+	Splits splits(const DataBox& root);
+
+	/// <summary>
+	/// <para>box̎q(@include)DataBoxTentriesɓo^</para>
+	/// </summary>
+	/// <param name="path">box̍ŏʂDataBox̕</param>
+	static void findIncludes(const DataBox& box, Path& path, std::map<Path, Entry>& entries, std::vector<Path>& found);
+
+	/// <returns>true=(@include)DataBoxŁAfileɃt@CpX</returns>
+	static bool include(const DataBox& box, std::string& file);
+
+	/// <summary>
+	/// <para>splitsDataBox͒g̑(@include)box</para>
+	/// </summary>
+	static std::string render(const DataBox& box, DataOutputStyle style, const Splits& splits);
+
+	/// <returns>t@C̓e, std::nullopt=JȂ</returns>
+	static std::optional<Content> read(const std::string& file);
+
+	/// <returns>true=t@Cǂ(@include)̃pXƂĎg鑊΃pX</returns>
+	static bool relative(const std::string& file);
+
+	static bool write(const std::string& file, const std::string& text);
+	static std::string directory(const std::string& path);
+	static std::string join(const std::string& directory, const std::string& file);
+	static const DataBox* find(const DataBox& root, const Path& path);
+	static DataBox* find(DataBox& root, const Path& path);
+
+private:
+	std::map<Path, Entry> m_entries;
+	std::string m_path;
+	std::string m_directory;
+	std::optional<DataOutputStyle> m_style;
+	uint64_t m_textHash;
+	size_t m_written;
+};
+
+
+
+
+inline DataSplitFile::DataSplitFile()
+	: m_entries()
+	, m_path()
+	, m_directory()
+	, m_style()
+	, m_textHash()
+	, m_written()
+{
+}
+
+inline void DataSplitFile::split(const std::vector<std::string>& path, const std::string& file)
+{
+	if (path.empty())
+		throw std::invalid_argument("DataSplitFile: empty path");
+	if (file.empty() || file.find_first_of("\"\n") != std::string::npos)
+		throw std::invalid_argument("DataSplitFile: invalid file " + file);
+
+	auto i = m_entries.find(path);
+	if (i == m_entries.end())
+	{
+		m_entries.emplace(path, Entry{file, std::nullopt, 0, true, false});
+	}
+	else if (i->second.file != file)
+	{
+		i->second.file = file;
+		i->second.written = false;
+	}
+}
+
+inline const std::string* DataSplitFile::file(const std::vector<std::string>& path) const
+{
+	auto i = m_entries.find(path);
+	return i == m_entries.end() ? nullptr : &i->second.file;
+}
+
+inline bool DataSplitFile::outputFile(const DataBox& box, const char* path, DataOutputStyle style)
+{
+	m_written = 0;
+
+	// ʂ̏ꏊEŏoꍇ͑Sď
+	// ǂݍ񂾌͏Ȃ̂ŁAǂݍ񂾓eƔׂČ߂
+	bool rewrite = m_path != path || (m_style && *m_style != style);
+	if (rewrite)
+	{
+		for (auto& i : m_entries)
+			i.second.written = false;
+	}
+
+	std::string dir = directory(path);
+	Splits s = splits(box);
+	bool result = true;
+
+	{
+		std::string text = render(box, style, s);
+		uint64_t h = DataHash::bytes(text.data(), text.size());
+		if (rewrite || h != m_textHash)
+		{
+			if (write(path, text))
+			{
+				m_textHash = h;
+				++m_written;
+			}
+			else
+			{
+				result = false;
+			}
+		}
+	}
+
+	for (auto& i : s)
+	{
+		Entry& e = *i.second;
+		if (!e.loaded)
+			continue;
+
+		// nbVlςĂȂΏȂ (ǂݍ񂾌̓nbVlȂ̂ŕK)
+		// qŕDataBoxςꍇ́A񂪕ςȂ̂ŏ܂Ȃ
+		uint64_t h = i.first->hash();
+		if (e.written && h == e.hash)
+			continue;
+		std::string text = render(*i.first, style, s);
+		uint64_t t = DataHash::bytes(text.data(), text.size());
+		if (!e.written || t != e.textHash)
+		{
+			if (!write(join(dir, e.file), text))
+			{
+				result = false;
+				continue;
+			}
+			e.textHash = t;
+			e.written = true;
+			++m_written;
+		}
+		e.hash = h;
+	}
+
+	m_path = path;
+	m_directory = dir;
+	m_style = style;
+	return result;
+}
+
+inline bool DataSplitFile::inputFile(DataBox& box, const char* path, DataSplitLoad load, DataThreadPool& pool)
+{
+	// sƂɏԒlύXȂ悤AʂDataSplitFileɓ͂Ăւ
+	std::optional<Content> root = read(path);
+	if (!root)
+		return false;
+
+	DataSplitFile next;
+	next.m_path = path;
+	next.m_directory = directory(path);
+	next.m_textHash = root->textHash;
+
+	Path p;
+	std::vector<Path> found;
+	findIncludes(root->box, p, next.m_entries, found);
+	if (load == DataSplitLoad::PARALLEL && !next.load(root->box, std::move(found), pool))
+		return false;
+
+	box = std::move(root->box);
+	m_entries.swap(next.m_entries);
+	m_path.swap(next.m_path);
+	m_directory.swap(next.m_directory);
+	m_style = next.m_style;
+	m_textHash = next.m_textHash;
+	m_written = 0;
+	return true;
+}
+
+inline bool DataSplitFile::resolve(DataBox& box, const std::vector<std::string>& path, DataThreadPool& pool)
+{
+	auto i = m_entries.find(path);
+	if (i == m_entries.end() || !find(box, path))
+		return false;
+	if (i->second.loaded)
+		return true;
+
+	return load(box, std::vector<Path>{path}, pool);
+}
+
+inline size_t DataSplitFile::written() const
+{
+	return m_written;
+}
+
+inline bool DataSplitFile::load(DataBox& root, std::vector<Path>&& pending, DataThreadPool& pool)
+{
+	// q(@include)́ASēǂݍ߂܂m_entriesƂ͕ʂɓo^Ă
+	std::map<Path, Entry> found;
+	auto entry = [this, &found](const Path& path) -> Entry&
+	{
+		auto i = found.find(path);
+		return i != found.end() ? i->second : m_entries.at(path);
+	};
+
+	std::deque<std::pair<Path, std::future<std::optional<Content>>>> tasks;
+	auto submit = [this, &pool, &tasks, &entry](Path&& path)
+	{
+		std::string file = join(m_directory, entry(path).file);
+		auto future = pool.submit([file]() { return read(file); });
+		tasks.emplace_back(std::move(path), std::move(future));
+	};
+	for (auto& i : pending)
+		submit(std::move(i));
+
+	// ẽt@CɓǂݏÎŁAǂݍ񂾏ɒuΓq(@include)u
+	std::vector<std::pair<Path, Content>> loaded;
+	while (!tasks.empty())
+	{
+		Path path = std::move(tasks.front().first);
+		std::optional<Content> c = tasks.front().second.get();
+		tasks.pop_front();
+		if (!c)
+			return false;
+
+		Path p = path;
+		std::vector<Path> nested;
+		findIncludes(c->box, p, found, nested);
+		for (auto& i : nested)
+			submit(std::move(i));
+		loaded.emplace_back(std::move(path), std::move(*c));
+	}
+
+	for (auto& i : found)
+		m_entries[i.first] = std::move(i.second);
+	for (auto& i : loaded)
+	{
+		DataBox& b = *find(root, i.first);
+		b = std::move(i.second.box);
+		Entry& e = m_entries.at(i.first);
+		e.textHash = i.second.textHash;
+		e.hash.reset();
+		e.loaded = true;
+		e.written = true;
+	}
+
+	return true;
+}
+
+inline DataSplitFile::Splits DataSplitFile::splits(const DataBox& root)
+{
+	Splits s;
+	for (auto& i : m_entries)
+	{
+		if (const DataBox* b = find(root, i.first))
+			s.emplace(b, &i.second);
+	}
+	return s;
+}
+
+inline void DataSplitFile::findIncludes(const DataBox& box, Path& path, std::map<Path, Entry>& entries, std::vector<Path>& found)
+{
+	std::string file;
+	for (auto& i : box.boxes())
+	{
+		path.push_back(i.first);
+		if (include(i.second, file))
+		{
+			if (!relative(file))
+				throw std::invalid_argument("DataSplitFile: include path must be relative " + file);
+			entries[path] = Entry{file, std::nullopt, 0, false, false};
+			found.push_back(path);
+		}
+		else
+		{
+			findIncludes(i.second, path, entries, found);
+		}
+		path.pop_back();
+	}
+}
+
+inline bool DataSplitFile::include(const DataBox& box, std::string& file)
+{
+	if (!box.boxes().empty() || box.items().size() != 1)
+		return false;
+	const DataItem* item = box.findItem(INCLUDE);
+	if (!item)
+		return false;
+
+	// DataItem"ň͂ŏ
+	std::string_view s = (*item)();
+	if (s.size() < 3 || s.front() != '\"' || s.back() != '\"')
+		return false;
+	file.assign(s.substr(1, s.size() - 2));
+	return true;
+}
+
+inline std::string DataSplitFile::render(const DataBox& box, DataOutputStyle style, const Splits& splits)
+{
+	// DataBox͒g̑(@include)
+	auto child = [&splits](const DataBox& b, std::string& text, const std::string& indent)
+	{
+		auto i = splits.find(&b);
+		if (i == splits.end())
+			return false;
+		text += indent;
+		text += '(';
+		text += INCLUDE;
+		text += ")\"";
+		text += i->second->file;
+		text += "\"\n";
+		return true;
+	};
+
+	std::string text;
+	FDA_TRACE_PHASE(DataTracePhase::FORMAT);
+	box.output(text, std::string(), style, [](std::string&) {}, child);
+	return text;
+}
+
+inline std::optional<DataSplitFile::Content> DataSplitFile::read(const std::string& file)
+{
+	std::ifstream o(file, std::ios::in);
+	if (!o)
+		return std::nullopt;
+
+	std::string s;
+	{
+		FDA_TRACE_PHASE(DataTracePhase::READ);
+		s.assign((std::istreambuf_iterator<char>(o)), std::istreambuf_iterator<char>());
+	}
+	std::optional<Content> c(Content{DataBox(), DataHash::bytes(s.data(), s.size())});
+	DataParseResult r = c->box.parse(s);
+	if (!r)
+		throw std::invalid_argument("DataSplitFile: " + file + ": " + r.message() + " at " + std::to_string(r.position));
+
+	return c;
+}
+
+inline bool DataSplitFile::relative(const std::string& file)
+{
+	if (file.front() == '/' || file.front() == '\\' || file.find(':') != std::string::npos)
+		return false;
+
+	// ŏʂ̃t@C̃fBNg̊OwȂ悤A..̗vfۂ
+	size_t first = 0;
+	while (first <= file.size())
+	{
+		size_t last = file.find_first_of("/\\", first);
+		if (last == std::string::npos)
+			last = file.size();
+		if (file.compare(first, last - first, "..") == 0)
+			return false;
+		first = last + 1;
+	}
+	return true;
+}
+
+inline bool DataSplitFile::write(const std::string& file, const std::string& text)
+{
+	std::ofstream o(file, std::ios::out);
+	if (!o)
+		return false;
+
+	FDA_TRACE_PHASE(DataTracePhase::WRITE);
+	o.write(text.c_str(), text.size());
+	return static_cast<bool>(o);
+}
+
+inline std::string DataSplitFile::directory(const std::string& path)
+{
+	size_t i = path.find_last_of("/\\");
+	return i == std::string::npos ? std::string() : path.substr(0, i + 1);
+}
+
+inline std::string DataSplitFile::join(const std::string& directory, const std::string& file)
+{
+	// ΃pX͂̂܂܎g
+	if (file.front() == '/' || file.front() == '\\' || file.find(':') != std::string::npos)
+		return file;
+	return directory + file;
+}
+
+inline const DataBox* DataSplitFile::find(const DataBox& root, const Path& path)
+{
+	const DataBox* b = &root;
+	for (auto& i : path)
+	{
+		b = b->findBox(i);
+		if (!b)
+			return nullptr;
+	}
+	return b;
+}
+
+inline DataBox* DataSplitFile::find(DataBox& root, const Path& path)
+{
+	return const_cast<DataBox*>(find(static_cast<const DataBox&>(root), path));
+}
@@ -0,0 +1,626 @@
+#pragma once
+
+#include "DataReader.h"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class DataTableRow;
+class DataTableCell;
+
+/// <summary>
+/// <para>OE^DataItemZDataBoxA\ƂĂ܂Ƃ߂Ċi[NX</para>
+/// <para>qDataBoxsADataItem̖OƂA񂲂Ƃɒl1̘AzɊi[</para>
+/// <para>sƂDataBoxstd::map̃m[hAlƂDataItemƃq[v̈Ȃ̂ŁA1s͍̃s̖Oƒl̃oCgxɂȂ</para>
+/// <para>column()Ō^t̔zƂĂ̂܂ܑł</para>
+/// <para>i[ł͔̂złȂl (kI[͔zȂ̂Ŋi[łȂ)</para>
+/// <para>s͖OɕׂĂBOɒǉꍇ͖ɒǉ邾ōς</para>
+/// </summary>
+class DataTable
+{
+public:
+	/// <summary>
+	/// <para>1̗</para>
+	/// <para>dataɂ1selementSizeoCg̒ls̏ɕ</para>
+	/// </summary>
+	struct Column
+	{
+		std::string name;
+		size_t elementSize;
+		DataFormat format;
+		std::vector<unsigned char> data;
+	};
+
+public:
+	DataTable();
+
+public:
+	/// <summary>
+	/// <para>box̎qDataBoxsƂĕ\蒼</para>
+	/// <para>SĂ̎qDataBoxOE^̃TCYE^Cv́AzłȂDataItem</para>
+	/// <para>ȂꍇboxDataItemꍇ͎sA\͕ύXȂ</para>
+	/// </summary>
+	/// <returns>true=, false=\ɂłȂ</returns>
+	bool assign(const DataBox& box);
+
+	/// <summary>
+	/// <para>sǉ</para>
+	/// <para>s̖O݂ꍇ㏑</para>
+	/// <para>sꍇArowDataItemߒ</para>
+	/// </summary>
+	/// <param name="name">s̖O</param>
+	/// <param name="row">ƓOE^DataItemDataBox</param>
+	/// <returns>true=, false=ƍȂ</returns>
+	bool addRow(std::string_view name, const DataBox& row);
+
+	/// <summary>
+	/// <para>s폜</para>
+	/// </summary>
+	/// <returns>true=폜, false=s̖O݂Ȃ</returns>
+	bool removeRow(std::string_view name);
+
+	/// <summary>
+	/// <para>sƗSč폜</para>
+	/// </summary>
+	void clear();
+
+	/// <summary>
+	/// <para>sɃANZX</para>
+	/// <para>s̖O݂ȂꍇO</para>
+	/// </summary>
+	DataTableRow operator[](std::string_view name) const;
+
+	/// <returns>true=s̖O݂</returns>
+	bool box(std::string_view name) const;
+
+	/// <returns>s̐</returns>
+	size_t rowCount() const;
+
+	/// <returns>̐</returns>
+	size_t columnCount() const;
+
+	/// <returns>OindexԖڂ̍s̖O</returns>
+	const std::string& rowNameAt(size_t index) const;
+
+	/// <returns>OindexԖڂ̍s</returns>
+	DataTableRow rowAt(size_t index) const;
+
+	/// <returns>OindexԖڂ̗</returns>
+	const Column& columnAt(size_t index) const;
+
+	/// <summary>
+	/// <para>̒ls̏ɕ񂾔zƂĎQƂ</para>
+	/// <para>̖O݂ȂꍇƁA^̃TCYقȂꍇ͗O</para>
+	/// <para>|C^͍sǉE폜܂ŗL</para>
+	/// </summary>
+	template<typename T>
+	T* column(std::string_view name);
+
+	template<typename T>
+	const T* column(std::string_view name) const;
+
+	/// <summary>
+	/// <para>gDataBoxhash()Ɠl</para>
+	/// <para>LbVȂ̂ŁAĂԂтɑSĂ̒lH</para>
+	/// </summary>
+	uint64_t hash() const;
+
+	/// <summary>
+	/// <para>ggDataBoxƓǂnbVlŔr</para>
+	/// </summary>
+	/// <returns>true=</returns>
+	bool equals(const DataBox& box) const;
+
+	/// <returns>sqDataBoxƂĎDataBox</returns>
+	DataBox toBox() const;
+
+	/// <summary>
+	/// <para>DataBox̃t@C1sǂݍŕ\ɂ</para>
+	/// <para>t@C̏ԈĂƗO</para>
+	/// </summary>
+	/// <param name="path">̓t@CpX</param>
+	/// <returns>true=, false=t@CJȂ\ɂłȂ (\͕ύXȂ)</returns>
+	bool inputFile(const char* path);
+
+	/// <summary>
+	/// <para>toBox()DataBox::outputFile()ŏo͂̂ƓŃt@C֏o͂</para>
+	/// <para>lDataItem::appendFormat()ŏ</para>
+	/// </summary>
+	/// <param name="path">o̓t@CpX</param>
+	/// <param name="style">o͂̏</param>
+	/// <returns>true=, false=s</returns>
+	bool outputFile(const char* path, DataOutputStyle style = DataOutputStyle::INDENTED) const;
+
+private:
+	bool matches(const DataBox& row) const;
+	size_t lowerBound(std::string_view name) const;
+	size_t find(std::string_view name) const;
+	const Column* findColumn(std::string_view name) const;
+
+private:
+	friend class DataTableRow;
+
+	std::vector<std::string> m_rows;
+	std::vector<Column> m_columns;
+};
+
+/// <summary>
+/// <para>DataTable1sQƂNX</para>
+/// <para>DataBoxƓ悤operator()Œl擾ł</para>
+/// <para>sǉE폜ƎgȂȂ</para>
+/// </summary>
+class DataTableRow
+{
+public:
+	DataTableRow(const DataTable* table, size_t index);
+
+public:
+	/// <summary>
+	/// <para>DataItemɃANZX</para>
+	/// <para>̖O݂ȂꍇO</para>
+	/// </summary>
+	DataTableCell operator()(std::string_view name) const;
+
+	/// <returns>true=̖O݂</returns>
+	bool item(std::string_view name) const;
+
+	/// <returns>s̖O</returns>
+	const std::string& name() const;
+
+	/// <returns>lDeepRs[DataBox</returns>
+	DataBox load() const;
+
+private:
+	const DataTable* m_table;
+	size_t m_index;
+};
+
+/// <summary>
+/// <para>DataTable1̒lQƂNX</para>
+/// <para>DataItemƓ悤ɒl̎擾ł</para>
+/// </summary>
+class DataTableCell
+{
+public:
+	DataTableCell(const DataTable::Column* column, size_t index);
+
+public:
+	/// <returns>g̏Ԓl</returns>
+	std::string operator()() const;
+
+	/// <summary>
+	/// <para>LXg邱ƂŕێĂlm邱Ƃł</para>
+	/// <para>^̃TCYقȂƗO</para>
+	/// </summary>
+	template<typename T>
+	operator T() const;
+
+	/// <summary>
+	/// <para>LXgƓێĂlo</para>
+	/// <para>^̃TCYقȂꍇAO𓊂std::nulloptԂ</para>
+	/// </summary>
+	template<typename T>
+	std::optional<T> tryAs() const;
+
+	/// <returns>lDeepRs[DataItem</returns>
+	DataItem item() const;
+
+	size_t getElementSize() const;
+	DataFormat getFormat() const;
+	const void* getElementPointer() const;
+
+private:
+	const DataTable::Column* m_column;
+	size_t m_index;
+};
+
+
+
+
+inline DataTable::DataTable()
+	: m_rows()
+	, m_columns()
+{
+}
+
+inline bool DataTable::assign(const DataBox& box)
+{
+	if (!box.items().empty())
+		return false;
+
+	// sƂɕ\ύXȂ悤Aʂ̕\ɒǉĂւ
+	// qDataBox͖OɒĤŁAǂ̍sɒǉ
+	DataTable t;
+	t.m_rows.reserve(box.boxes().size());
+	for (auto& i : box.boxes())
+	{
+		if (!t.addRow(i.first, i.second))
+			return false;
+	}
+	*this = std::move(t);
+	return true;
+}
+
+inline bool DataTable::addRow(std::string_view name, const DataBox& row)
+{
+	if (m_rows.empty())
+	{
+		if (!row.boxes().empty())
+			return false;
+		std::vector<Column> columns;
+		columns.reserve(row.items().size());
+		for (auto& i : row.items())
+		{
+			const DataItem& item = i.second;
+			if (item.getElementCount() != 0)
+				return false;
+			columns.push_back(Column{i.first, item.getElementSize(), item.getFormat(), std::vector<unsigned char>()});
+		}
+		m_columns = std::move(columns);
+	}
+	else if (!matches(row))
+	{
+		return false;
+	}
+
+	// DataBox::add()ƓAȂTȂ
+	size_t index = m_rows.size();
+	if (!m_rows.empty() && !(m_rows.back() < name))
+	{
+		index = lowerBound(name);
+		if (index == m_rows.size() || m_rows[index] != name)
+		{
+			m_rows.insert(m_rows.begin() + index, std::string(name));
+			for (auto& c : m_columns)
+				c.data.insert(c.data.begin() + index * c.elementSize, c.elementSize, 0);
+		}
+	}
+	else
+	{
+		m_rows.emplace_back(name);
+		for (auto& c : m_columns)
+			c.data.resize(c.data.size() + c.elementSize);
+	}
+
+	// DataItemOȂ̂œɒH
+	auto c = m_columns.begin();
+	for (auto& i : row.items())
+	{
+		memcpy(c->data.data() + index * c->elementSize, i.second.getElementPointer(), c->elementSize);
+		++c;
+	}
+	return true;
+}
+
+inline bool DataTable::removeRow(std::string_view name)
+{
+	size_t index = find(name);
+	if (index == m_rows.size())
+		return false;
+
+	m_rows.erase(m_rows.begin() + index);
+	for (auto& c : m_columns)
+	{
+		auto first = c.data.begin() + index * c.elementSize;
+		c.data.erase(first, first + c.elementSize);
+	}
+	return true;
+}
+
+inline void DataTable::clear()
+{
+	m_rows.clear();
+	m_columns.clear();
+}
+
+inline DataTableRow DataTable::operator[](std::string_view name) const
+{
+	size_t index = find(name);
+	if (index == m_rows.size())
+		throw std::out_of_range("DataTable: row not found " + std::string(name));
+	return DataTableRow(this, index);
+}
+
+inline bool DataTable::box(std::string_view name) const
+{
+	return find(name) != m_rows.size();
+}
+
+inline size_t DataTable::rowCount() const
+{
+	return m_rows.size();
+}
+
+inline size_t DataTable::columnCount() const
+{
+	return m_columns.size();
+}
+
+inline const std::string& DataTable::rowNameAt(size_t index) const
+{
+	return m_rows[index];
+}
+
+inline DataTableRow DataTable::rowAt(size_t index) const
+{
+	return DataTableRow(this, index);
+}
+
+inline const DataTable::Column& DataTable::columnAt(size_t index) const
+{
+	return m_columns[index];
+}
+
+template<typename T>
+inline T* DataTable::column(std::string_view name)
+{
+	return const_cast<T*>(static_cast<const DataTable*>(this)->column<T>(name));
+}
+
+template<typename T>
+inline const T* DataTable::column(std::string_view name) const
+{
+	static_assert(!std::is_pointer_v<T> && !std::is_array_v<T>, "|C^Ez͖");
+
+	const Column* c = findColumn(name);
+	if (!c)
+		throw std::out_of_range("DataTable: column not found " + std::string(name));
+	if (std::alignment_of_v<T> != c->elementSize)
+		throw std::runtime_error("DataTable: type mismatch");
+
+	return reinterpret_cast<const T*>(c->data.data());
+}
+
+inline uint64_t DataTable::hash() const
+{
+	// DataBox::hash()DataItem::hash()Ɠɓl
+	std::vector<uint64_t> seeds;
+	std::vector<uint64_t> names;
+	seeds.reserve(m_columns.size());
+	names.reserve(m_columns.size());
+	for (auto& c : m_columns)
+	{
+		seeds.push_back(DataHash::combine(DataHash::combine(c.elementSize, 0), static_cast<uint64_t>(c.format)));
+		names.push_back(DataHash::bytes(c.name.data(), c.name.size(), 1));
+	}
+
+	uint64_t h = 0;
+	for (size_t r = 0; r < m_rows.size(); ++r)
+	{
+		uint64_t row = 0;
+		for (size_t c = 0; c < m_columns.size(); ++c)
+		{
+			const Column& column = m_columns[c];
+			row = DataHash::combine(row, names[c]);
+			row = DataHash::combine(row, DataHash::bytes(column.data.data() + r * column.elementSize, column.elementSize, seeds[c]));
+		}
+		h = DataHash::combine(h, DataHash::bytes(m_rows[r].data(), m_rows[r].size(), 2));
+		h = DataHash::combine(h, row);
+	}
+	return h;
+}
+
+inline bool DataTable::equals(const DataBox& box) const
+{
+	return hash() == box.hash();
+}
+
+inline DataBox DataTable::toBox() const
+{
+	std::vector<std::pair<std::string, DataBox>> rows;
+	rows.reserve(m_rows.size());
+	for (size_t r = 0; r < m_rows.size(); ++r)
+		rows.emplace_back(m_rows[r], rowAt(r).load());
+
+	DataBox box;
+	box.add(std::move(rows));
+	return box;
+}
+
+inline bool DataTable::inputFile(const char* path)
+{
+	DataReader reader;
+	if (!reader.open(path))
+		return false;
+
+	// 1sDataBoxɂĒǉ̂ŁAt@CŜ̖؂͍Ȃ
+	DataTable t;
+	while (true)
+	{
+		DataReaderEvent e = reader.next();
+		if (e == DataReaderEvent::END)
+			break;
+		if (e != DataReaderEvent::BOX_BEGIN)
+			return false;
+
+		std::string name(reader.name());
+		if (!t.addRow(name, reader.readBox()))
+			return false;
+	}
+	*this = std::move(t);
+	return true;
+}
+
+inline bool DataTable::outputFile(const char* path, DataOutputStyle style) const
+{
+	std::ofstream o(path, std::ios::out);
+	if (!o)
+		return false;
+
+	std::string s;
+	{
+		FDA_TRACE_PHASE(DataTracePhase::FORMAT);
+		bool minified = style == DataOutputStyle::MINIFIED;
+		for (size_t r = 0; r < m_rows.size(); ++r)
+		{
+			s += '[';
+			s += m_rows[r];
+			s += "]\n";
+			for (auto& c : m_columns)
+			{
+				s += minified ? "(" : "  (";
+				s += c.name;
+				s += ')';
+				DataItem::appendFormat(s, c.format, c.elementSize, 0, c.data.data() + r * c.elementSize);
+				s += '\n';
+			}
+			if (minified)
+			{
+				s += "[/]\n";
+			}
+			else
+			{
+				s += "[/";
+				s += m_rows[r];
+				s += "]\n";
+			}
+		}
+	}
+	{
+		FDA_TRACE_PHASE(DataTracePhase::WRITE);
+		o.write(s.c_str(), s.size());
+		o.flush();
+	}
+
+	return !o.fail();
+}
+
+inline bool DataTable::matches(const DataBox& row) const
+{
+	if (!row.boxes().empty() || row.items().size() != m_columns.size())
+		return false;
+
+	auto c = m_columns.begin();
+	for (auto& i : row.items())
+	{
+		const DataItem& item = i.second;
+		if (i.first != c->name
+			|| item.getElementCount() != 0
+			|| item.getElementSize() != c->elementSize
+			|| item.getFormat() != c->format)
+			return false;
+		++c;
+	}
+	return true;
+}
+
+inline size_t DataTable::lowerBound(std::string_view name) const
+{
+	return static_cast<size_t>(std::lower_bound(m_rows.begin(), m_rows.end(), name,
+		[](const std::string& a, std::string_view b) { return a < b; }) - m_rows.begin());
+}
+
+inline size_t DataTable::find(std::string_view name) const
+{
+	size_t index = lowerBound(name);
+	if (index != m_rows.size() && m_rows[index] != name)
+		return m_rows.size();
+	return index;
+}
+
+inline const DataTable::Column* DataTable::findColumn(std::string_view name) const
+{
+	// ͏Ȃ̂Ő擪T
+	for (auto& c : m_columns)
+	{
+		if (c.name == name)
+			return &c;
+	}
+	return nullptr;
+}
+
+inline DataTableRow::DataTableRow(const DataTable* table, size_t index)
+	: m_table(table)
+	, m_index(index)
+{
+}
+
+inline DataTableCell DataTableRow::operator()(std::string_view name) const
+{
+	const DataTable::Column* c = m_table->findColumn(name);
+	if (!c)
+		throw std::out_of_range("DataTableRow: item not found " + std::string(name));
+	return DataTableCell(c, m_index);
+}
+
+inline bool DataTableRow::item(std::string_view name) const
+{
+	return m_table->findColumn(name) != nullptr;
+}
+
+inline const std::string& DataTableRow::name() const
+{
+	return m_table->m_rows[m_index];
+}
+
+inline DataBox DataTableRow::load() const
+{
+	std::vector<std::pair<std::string, DataItem>> items;
+	items.reserve(m_table->m_columns.size());
+	for (auto& c : m_table->m_columns)
+		items.emplace_back(c.name, DataTableCell(&c, m_index).item());
+
+	DataBox box;
+	box.add(std::move(items));
+	return box;
+}
+
+inline DataTableCell::DataTableCell(const DataTable::Column* column, size_t index)
+	: m_column(column)
+	, m_index(index)
+{
+}
+
+inline std::string DataTableCell::operator()() const
+{
+	std::string text;
+	DataItem::appendFormat(text, getFormat(), getElementSize(), 0, getElementPointer());
+	return text;
+}
+
+template<typename T>
+inline DataTableCell::operator T() const
+{
+	static_assert(!std::is_pointer_v<T> && !std::is_array_v<T>, "|C^Ez͖");
+
+	if (std::alignment_of_v<T> != m_column->elementSize)
+		throw std::runtime_error("DataTableCell: type mismatch");
+
+	return *static_cast<const T*>(getElementPointer());
+}
+
+template<typename T>
+inline std::optional<T> DataTableCell::tryAs() const
+{
+	static_assert(!std::is_pointer_v<T> && !std::is_array_v<T>, "|C^Ez͖");
+
+	if (std::alignment_of_v<T> != m_column->elementSize)
+		return std::nullopt;
+
+	return *static_cast<const T*>(getElementPointer());
+}
+
+inline DataItem DataTableCell::item() const
+{
+	return DataItem::createFromMemory(getElementSize(), 0, getFormat(), getElementPointer());
+}
+
+inline size_t DataTableCell::getElementSize() const
+{
+	return m_column->elementSize;
+}
+
+inline DataFormat DataTableCell::getFormat() const
+{
+	return m_column->format;
+}
+
+inline const void* DataTableCell::getElementPointer() const
+{
+	return m_column->data.data() + m_index * m_column->elementSize;
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/// <summary>
+/// <para>񓯊̓ǂݏ񏈗ŎgXbhv[</para>
+/// <para>jƂ͐ς܂Ă鏈SĎsĂXbhI</para>
+/// </summary>
+class DataThreadPool
+{
+public:
+	/// <summary>
+	/// <para>XbhN</para>
+	/// </summary>
+	/// <param name="threadCount">Xbh (0̏ꍇ1)</param>
+	explicit DataThreadPool(size_t threadCount);
+	~DataThreadPool();
+
+	DataThreadPool(const DataThreadPool&) = delete;
+	DataThreadPool& operator=(const DataThreadPool&) = delete;
+
+public:
+	/// <summary>
+	/// <para>ς</para>
+	/// </summary>
+	void post(std::function<void()> task);
+
+	/// <summary>
+	/// <para>ς݁Aʂ󂯎std::futureԂ</para>
+	/// <para>Ostd::future::get()œ</para>
+	/// </summary>
+	template<typename Function>
+	std::future<std::invoke_result_t<Function>> submit(Function&& function);
+
+	/// <returns>Xbh</returns>
+	size_t size() const;
+
+	/// <summary>
+	/// <para>CuŜŋLXbhv[</para>
+	/// <para>ǂݍ݂Ə݂d˂悤ɁAXbh2ȏɂĂ</para>
+	/// </summary>
+	static DataThreadPool& shared();
+
+private:
+	void run();
+
+private:
+	std::vector<std::thread> m_threads;
+	std::deque<std::function<void()>> m_tasks;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	bool m_stop;
+};
+
+
+
+
+inline DataThreadPool::DataThreadPool(size_t threadCount)
+	: m_threads()
+	, m_tasks()
+	, m_mutex()
+	, m_condition()
+	, m_stop()
+{
+	if (threadCount == 0)
+		threadCount = 1;
+	for (size_t i = 0; i < threadCount; ++i)
+		m_threads.emplace_back(&DataThreadPool::run, this);
+}
+
+inline DataThreadPool::~DataThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_condition.notify_all();
+	for (auto& i : m_threads)
+		i.join();
+}
+
+inline void DataThreadPool::post(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_tasks.push_back(std::move(task));
+	}
+	m_condition.notify_one();
+}
+
+template<typename Function>
+inline std::future<std::invoke_result_t<Function>> DataThreadPool::submit(Function&& function)
+{
+	// std::function̓Rs[\Ȋ֐ĂȂ̂std::shared_ptrŕ
+	auto task = std::make_shared<std::packaged_task<std::invoke_result_t<Function>()>>(std::forward<Function>(function));
+	auto future = task->get_future();
+	post([task]() { (*task)(); });
+	return future;
+}
+
+inline size_t DataThreadPool::size() const
+{
+	return m_threads.size();
+}
+
+inline DataThreadPool& DataThreadPool::shared()
+{
+	static DataThreadPool pool((std::max)(2u, std::thread::hardware_concurrency()));
+	return pool;
+}
+
+inline void DataThreadPool::run()
+{
+	while (true)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+			if (m_tasks.empty())
+				return;
+			task = std::move(m_tasks.front());
+			m_tasks.pop_front();
+		}
+		task();
+	}
+}
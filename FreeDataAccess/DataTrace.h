@@ -0,0 +1,340 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// <para>vJE^̎</para>
+/// <para>BOX_ACCESS=DataBox::operator[]̌Ăяo</para>
+/// <para>ITEM_ACCESS=DataBox::operator()̌Ăяo</para>
+/// <para>TEXT_CACHE_MISS=DataItem::operator()ŕLbV</para>
+/// <para>PAYLOAD_ALLOCATION=DataItemli[郁mۂ</para>
+/// </summary>
+enum class DataTraceCounter
+{
+	BOX_ACCESS,
+	ITEM_ACCESS,
+	TEXT_CACHE_MISS,
+	PAYLOAD_ALLOCATION,
+	COUNT
+};
+
+/// <summary>
+/// <para>vt@Co͂̍H</para>
+/// <para>READ=t@C̓ǂݍ</para>
+/// <para>SCAN=^Ǒ</para>
+/// <para>BUILD=DataItem̐DataBoxւ̒ǉ</para>
+/// <para>FORMAT=Ԓl̕</para>
+/// <para>WRITE=t@Cւ̏</para>
+/// </summary>
+enum class DataTracePhase
+{
+	READ,
+	SCAN,
+	BUILD,
+	FORMAT,
+	WRITE,
+	COUNT
+};
+
+/// <summary>
+/// <para>鎞_ł̌vlSXbhv</para>
+/// <para>H̎Ԃ͓qɂȂH̎Ԃ܂܂Ȃ</para>
+/// </summary>
+struct DataTraceSnapshot
+{
+	uint64_t counter[static_cast<size_t>(DataTraceCounter::COUNT)];
+	uint64_t phaseCount[static_cast<size_t>(DataTracePhase::COUNT)];
+	uint64_t phaseNanoseconds[static_cast<size_t>(DataTracePhase::COUNT)];
+};
+
+/// <summary>
+/// <para>zbgpX̌Ăяo񐔂ƃt@Co͂̍HԂvNX</para>
+/// <para>FREEDATAACCESS_TRACE`ăRpCꍇ̂݌v</para>
+/// <para>`ȂꍇAvp̃}N͉Ȃ</para>
+/// <para>JE^̓XbhƂɎ̂ŌvɃXbhԂ͔̓Ȃ</para>
+/// </summary>
+class DataTrace
+{
+public:
+	/// <summary>
+	/// <para>H̋EŌĂ΂֐</para>
+	/// </summary>
+	/// <param name="phase">H</param>
+	/// <param name="begin">true=Jn, false=I</param>
+	/// <param name="nanoseconds">Î݁A̍Hɂ</param>
+	using Callback = void(*)(DataTracePhase phase, bool begin, uint64_t nanoseconds);
+
+	/// <summary>
+	/// <para>H̋EŌĂ΂֐ݒ肷</para>
+	/// <para>nullptrŉ</para>
+	/// </summary>
+	static void setCallback(Callback callback);
+
+	/// <returns>SXbȟvl̍v</returns>
+	static DataTraceSnapshot snapshot();
+
+	/// <summary>
+	/// <para>snapshot()̌ʂDataBox̃t@Cŏo͂</para>
+	/// <para>DataBox::inputFile()ł̂܂ܓǂݍ߂</para>
+	/// </summary>
+	static std::string exportText();
+
+	/// <summary>
+	/// <para>SXbȟvl[ɂ</para>
+	/// </summary>
+	static void reset();
+
+	static const char* name(DataTraceCounter counter);
+	static const char* name(DataTracePhase phase);
+
+public:
+	/// <summary>
+	/// <para>JE^1₷</para>
+	/// <para>ڌĂ΂FDA_TRACE_COUNT}Ng</para>
+	/// </summary>
+	static void count(DataTraceCounter counter);
+
+	/// <summary>
+	/// <para>j܂ł1̍HƂČv</para>
+	/// <para>ڎg킸FDA_TRACE_PHASE}Ng</para>
+	/// </summary>
+	class Phase
+	{
+	public:
+		explicit Phase(DataTracePhase phase);
+		~Phase();
+
+		Phase(const Phase&) = delete;
+		Phase& operator=(const Phase&) = delete;
+
+	private:
+		DataTracePhase m_phase;
+		Phase* m_parent;
+		uint64_t m_start;
+		uint64_t m_elapsed;
+	};
+
+private:
+	struct Local
+	{
+		std::atomic<uint64_t> counter[static_cast<size_t>(DataTraceCounter::COUNT)];
+		std::atomic<uint64_t> phaseCount[static_cast<size_t>(DataTracePhase::COUNT)];
+		std::atomic<uint64_t> phaseNanoseconds[static_cast<size_t>(DataTracePhase::COUNT)];
+		Phase* current;
+
+		Local();
+		~Local();
+	};
+
+	static Local& local();
+	static uint64_t now();
+	static void add(std::atomic<uint64_t>& a, uint64_t v);
+	static void addTo(DataTraceSnapshot& s, const Local& l);
+
+private:
+	static std::mutex ms_mutex;
+	static std::vector<Local*> ms_locals;
+	static DataTraceSnapshot ms_retired;
+	static std::atomic<Callback> ms_callback;
+};
+
+#ifdef FREEDATAACCESS_TRACE
+#define FDA_TRACE_CONCAT2(a, b) a##b
+#define FDA_TRACE_CONCAT(a, b) FDA_TRACE_CONCAT2(a, b)
+#define FDA_TRACE_COUNT(counter) DataTrace::count(counter)
+#define FDA_TRACE_PHASE(phase) DataTrace::Phase FDA_TRACE_CONCAT(fdaTracePhase, __LINE__)(phase)
+#else
+#define FDA_TRACE_COUNT(counter) ((void)0)
+#define FDA_TRACE_PHASE(phase) ((void)0)
+#endif
+
+
+
+
+inline std::mutex DataTrace::ms_mutex;
+inline std::vector<DataTrace::Local*> DataTrace::ms_locals;
+inline DataTraceSnapshot DataTrace::ms_retired = {};
+inline std::atomic<DataTrace::Callback> DataTrace::ms_callback = nullptr;
+
+inline void DataTrace::setCallback(Callback callback)
+{
+	ms_callback.store(callback, std::memory_order_release);
+}
+
+inline DataTraceSnapshot DataTrace::snapshot()
+{
+	std::lock_guard<std::mutex> lock(ms_mutex);
+	DataTraceSnapshot s = ms_retired;
+	for (auto l : ms_locals)
+		addTo(s, *l);
+	return s;
+}
+
+inline std::string DataTrace::exportText()
+{
+	DataTraceSnapshot s = snapshot();
+
+	std::string text;
+	char buf[64] = {};
+
+	text.append("[counter]\n");
+	for (size_t i = 0; i < static_cast<size_t>(DataTraceCounter::COUNT); ++i)
+	{
+		snprintf(buf, sizeof(buf), "  (%s)0x%016llX\n", name(static_cast<DataTraceCounter>(i)), static_cast<unsigned long long>(s.counter[i]));
+		text.append(buf);
+	}
+	text.append("[/counter]\n");
+
+	for (size_t i = 0; i < static_cast<size_t>(DataTracePhase::COUNT); ++i)
+	{
+		const char* n = name(static_cast<DataTracePhase>(i));
+		snprintf(buf, sizeof(buf), "[%s]\n", n);
+		text.append(buf);
+		snprintf(buf, sizeof(buf), "  (count)0x%016llX\n", static_cast<unsigned long long>(s.phaseCount[i]));
+		text.append(buf);
+		snprintf(buf, sizeof(buf), "  (nanoseconds)0x%016llX\n", static_cast<unsigned long long>(s.phaseNanoseconds[i]));
+		text.append(buf);
+		snprintf(buf, sizeof(buf), "[/%s]\n", n);
+		text.append(buf);
+	}
+
+	return text;
+}
+
+inline void DataTrace::reset()
+{
+	std::lock_guard<std::mutex> lock(ms_mutex);
+	ms_retired = {};
+	for (auto l : ms_locals)
+	{
+		for (auto& c : l->counter) c.store(0, std::memory_order_relaxed);
+		for (auto& c : l->phaseCount) c.store(0, std::memory_order_relaxed);
+		for (auto& c : l->phaseNanoseconds) c.store(0, std::memory_order_relaxed);
+	}
+}
+
+inline const char* DataTrace::name(DataTraceCounter counter)
+{
+	switch (counter)
+	{
+	case DataTraceCounter::BOX_ACCESS: return "BOX_ACCESS";
+	case DataTraceCounter::ITEM_ACCESS: return "ITEM_ACCESS";
+	case DataTraceCounter::TEXT_CACHE_MISS: return "TEXT_CACHE_MISS";
+	case DataTraceCounter::PAYLOAD_ALLOCATION: return "PAYLOAD_ALLOCATION";
+	default: return "";
+	}
+}
+
+inline const char* DataTrace::name(DataTracePhase phase)
+{
+	switch (phase)
+	{
+	case DataTracePhase::READ: return "READ";
+	case DataTracePhase::SCAN: return "SCAN";
+	case DataTracePhase::BUILD: return "BUILD";
+	case DataTracePhase::FORMAT: return "FORMAT";
+	case DataTracePhase::WRITE: return "WRITE";
+	default: return "";
+	}
+}
+
+inline void DataTrace::count(DataTraceCounter counter)
+{
+	add(local().counter[static_cast<size_t>(counter)], 1);
+}
+
+inline DataTrace::Phase::Phase(DataTracePhase phase)
+	: m_phase(phase)
+	, m_parent()
+	, m_start(now())
+	, m_elapsed()
+{
+	// e̍H͈ꎞ~āAq̍H̎Ԃ܂܂Ȃ悤ɂ
+	Local& l = local();
+	m_parent = l.current;
+	if (m_parent)
+		m_parent->m_elapsed += m_start - m_parent->m_start;
+	l.current = this;
+
+	add(l.phaseCount[static_cast<size_t>(m_phase)], 1);
+
+	if (Callback c = ms_callback.load(std::memory_order_acquire))
+		c(m_phase, true, 0);
+}
+
+inline DataTrace::Phase::~Phase()
+{
+	uint64_t t = now();
+	m_elapsed += t - m_start;
+
+	Local& l = local();
+	add(l.phaseNanoseconds[static_cast<size_t>(m_phase)], m_elapsed);
+
+	// e̍HĊJ
+	l.current = m_parent;
+	if (m_parent)
+		m_parent->m_start = t;
+
+	if (Callback c = ms_callback.load(std::memory_order_acquire))
+		c(m_phase, false, m_elapsed);
+}
+
+inline DataTrace::Local::Local()
+	: counter()
+	, phaseCount()
+	, phaseNanoseconds()
+	, current()
+{
+	std::lock_guard<std::mutex> lock(ms_mutex);
+	ms_locals.push_back(this);
+}
+
+inline DataTrace::Local::~Local()
+{
+	// IXbȟvl͎Ȃ悤ɑޔĂ
+	std::lock_guard<std::mutex> lock(ms_mutex);
+	addTo(ms_retired, *this);
+	for (auto i = ms_locals.begin(); i != ms_locals.end(); ++i)
+	{
+		if (*i == this)
+		{
+			ms_locals.erase(i);
+			break;
+		}
+	}
+}
+
+inline DataTrace::Local& DataTrace::local()
+{
+	thread_local Local l;
+	return l;
+}
+
+inline uint64_t DataTrace::now()
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+inline void DataTrace::add(std::atomic<uint64_t>& a, uint64_t v)
+{
+	// ނ̂͏LXbhȂ̂fetch_add͕sv
+	a.store(a.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+}
+
+inline void DataTrace::addTo(DataTraceSnapshot& s, const Local& l)
+{
+	for (size_t i = 0; i < static_cast<size_t>(DataTraceCounter::COUNT); ++i)
+		s.counter[i] += l.counter[i].load(std::memory_order_relaxed);
+	for (size_t i = 0; i < static_cast<size_t>(DataTracePhase::COUNT); ++i)
+	{
+		s.phaseCount[i] += l.phaseCount[i].load(std::memory_order_relaxed);
+		s.phaseNanoseconds[i] += l.phaseNanoseconds[i].load(std::memory_order_relaxed);
+	}
+}
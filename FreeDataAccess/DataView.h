@@ -0,0 +1,658 @@
+#pragma once
+
+#include "DataBox.h"
+#include "DataMappedFile.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class DataBoxView;
+class DataItemView;
+
+/// <summary>
+/// <para>DataBoxǂݎp̃oCit@CɏoAɃ}bv܂܎QƂNX</para>
+/// <para>JƂ͑SĂ̕\̈ʒuƔ͈͂m߂邾ŁA؂\zlǂ܂Ȃ</para>
+/// <para>eDataBox͖Oɕ񂾎q̕\̂ŁA̓}bv̓񕪒TɂȂ</para>
+/// <para>l8oCgEɔzûŁALXgł̂܂܎QƂł</para>
+/// <para>COPYWRITEŊJƁAz̒lt@Cɒu܂܂DataBox</para>
+/// </summary>
+class DataView
+{
+public:
+	/// <summary>
+	/// <para>t@C̐擪</para>
+	/// </summary>
+	struct Header
+	{
+		char magic[4];
+		uint32_t version;
+		uint64_t root;
+		uint64_t size;
+	};
+
+	/// <summary>
+	/// <para>DataBox1̕\̐擪</para>
+	/// <para>ItemEntryitemCountABoxEntryboxCountAꂼꖼOɕ</para>
+	/// </summary>
+	struct BoxRecord
+	{
+		uint32_t itemCount;
+		uint32_t boxCount;
+		uint64_t hash;
+	};
+
+	struct ItemEntry
+	{
+		uint64_t name;
+		uint32_t nameLength;
+		uint32_t elementSize;
+		uint64_t elementCount;
+		uint32_t format;
+		uint32_t reserved;
+		uint64_t payload;
+	};
+
+	struct BoxEntry
+	{
+		uint64_t name;
+		uint32_t nameLength;
+		uint32_t reserved;
+		uint64_t box;
+	};
+
+	static constexpr uint32_t VERSION = 1;
+
+public:
+	DataView();
+
+	DataView(const DataView&) = delete;
+	DataView& operator=(const DataView&) = delete;
+
+public:
+	/// <summary>
+	/// <para>DataBoxoCit@C֏o͂</para>
+	/// <para>ꎞt@CɏoĂûŁAsẴt@C͉Ȃ</para>
+	/// </summary>
+	/// <param name="box">o͂DataBox</param>
+	/// <param name="path">o̓t@CpX</param>
+	/// <returns>true=, false=s</returns>
+	static bool write(const DataBox& box, const char* path);
+
+	/// <summary>
+	/// <para>write()ŏo͂t@CɃ}bv</para>
+	/// </summary>
+	/// <param name="path">̓t@CpX</param>
+	/// <param name="mode">}bv@ (map()gꍇCOPYWRITE)</param>
+	/// <returns>true=, false=s܂͏ႤE\̈ʒu͈͂t@C̊OwĂ</returns>
+	bool open(const char* path, DataMapMode mode = DataMapMode::READ);
+
+	/// <summary>
+	/// <para>t@C</para>
+	/// <para>DataView瓾DataBoxViewDataItemView, map()ōDataBox͎gȂȂ</para>
+	/// </summary>
+	void close();
+
+	/// <returns>ŏʂDataBox</returns>
+	DataBoxView root() const;
+
+	/// <summary>
+	/// <para>z̒lt@Cɒu܂܎QƂDataBox (DataItem::createFromMapping())</para>
+	/// <para>złȂDataItem̒l̓Rs[</para>
+	/// <para>WRITEŊJĂꍇAz̒lƃt@Cɔf (BoxRecord̃nbVl͏oƂ̂܂)</para>
+	/// <para>DataBoxRs[Ehash()߂ƔzŜt@Cǂݍ (nbVlDataBoxView::hash()œ)</para>
+	/// <para>COPYWRITEŊJĂȂƗO</para>
+	/// </summary>
+	DataBox map();
+
+	/// <returns>JĂt@C</returns>
+	const DataMappedFile& file() const;
+
+private:
+	class Writer;
+
+	DataBox map(const DataBoxView& view);
+
+	/// <summary>
+	/// <para>boẍʒuBoxRecordƂ̎q̕\EOEl͈̔͂t@CɎ܂Ă邩m߂</para>
+	/// <para>q͐eOɏôŁAq̈ʒulimitOɂ邱Ƃm߂ΏzȂ</para>
+	/// </summary>
+	bool valid(uint64_t box, uint64_t limit) const;
+
+	/// <returns>true=namëʒulengthƃkI[t@CɎ܂Ă</returns>
+	bool validName(uint64_t name, uint64_t length) const;
+
+private:
+	DataMappedFile m_file;
+};
+
+/// <summary>
+/// <para>}bvt@CDataItemQƂNX</para>
+/// <para>DataItemƓ悤ɒl̎擾ł</para>
+/// </summary>
+class DataItemView
+{
+public:
+	DataItemView(const char* base, const DataView::ItemEntry* entry);
+
+public:
+	/// <returns>g̏Ԓl</returns>
+	std::string operator()() const;
+
+	/// <summary>
+	/// <para>LXg邱ƂŕێĂlm邱Ƃł</para>
+	/// <para>^̃TCYقȂƗO</para>
+	/// </summary>
+	template<typename T>
+	operator T() const;
+
+	/// <summary>
+	/// <para>LXg邱ƂŕێĂlm邱Ƃł</para>
+	/// <para>^̃TCYقȂƗO</para>
+	/// </summary>
+	template<typename T>
+	operator const T* () const;
+
+	/// <returns>lDeepRs[DataItem</returns>
+	DataItem item() const;
+
+	size_t getElementSize() const;
+	size_t getElementCount() const;
+	DataFormat getFormat() const;
+	const void* getElementPointer() const;
+
+private:
+	const char* m_base;
+	const DataView::ItemEntry* m_entry;
+};
+
+/// <summary>
+/// <para>}bvt@CDataBoxQƂNX</para>
+/// <para>DataBoxƓ悤operator[]operator()ŎqH</para>
+/// </summary>
+class DataBoxView
+{
+public:
+	DataBoxView(const char* base, const DataView::BoxRecord* box);
+
+public:
+	/// <summary>
+	/// <para>DataBoxɃANZX</para>
+	/// <para>pX݂ȂꍇO</para>
+	/// </summary>
+	DataBoxView operator[](const char* path) const;
+
+	/// <summary>
+	/// <para>DataItemɃANZX</para>
+	/// <para>pX݂ȂꍇO</para>
+	/// </summary>
+	DataItemView operator()(const char* path) const;
+
+	/// <returns>true=DataBox̃pX݂</returns>
+	bool box(const char* path) const;
+
+	/// <returns>true=DataItem̃pX݂</returns>
+	bool item(const char* path) const;
+
+	/// <returns>qDataBox̐</returns>
+	size_t boxCount() const;
+
+	/// <returns>qDataItem̐</returns>
+	size_t itemCount() const;
+
+	/// <returns>OindexԖڂ̎qDataBox̖O</returns>
+	const char* boxNameAt(size_t index) const;
+
+	/// <returns>OindexԖڂ̎qDataBox</returns>
+	DataBoxView boxAt(size_t index) const;
+
+	/// <returns>OindexԖڂ̎qDataItem̖O</returns>
+	const char* itemNameAt(size_t index) const;
+
+	/// <returns>OindexԖڂ̎qDataItem</returns>
+	DataItemView itemAt(size_t index) const;
+
+	/// <returns>oƂDataBox::hash()</returns>
+	uint64_t hash() const;
+
+	/// <returns>gSăRs[DataBox</returns>
+	DataBox load() const;
+
+private:
+	const DataView::ItemEntry* items() const;
+	const DataView::BoxEntry* boxes() const;
+	const DataView::ItemEntry* findItem(const char* path) const;
+	const DataView::BoxEntry* findBox(const char* path) const;
+
+private:
+	const char* m_base;
+	const DataView::BoxRecord* m_box;
+};
+
+/// <summary>
+/// <para>DataView::write()̎</para>
+/// <para>qɏoĈʒum肳Ăe̕\o</para>
+/// </summary>
+class DataView::Writer
+{
+public:
+	explicit Writer(const char* path);
+
+	bool write(const DataBox& box);
+
+private:
+	uint64_t box(const DataBox& box);
+	uint64_t bytes(const void* data, size_t size);
+	void align();
+
+private:
+	std::ofstream m_file;
+	uint64_t m_position;
+};
+
+
+
+
+inline DataView::DataView()
+	: m_file()
+{
+}
+
+inline bool DataView::write(const DataBox& box, const char* path)
+{
+	std::string temp = std::string(path) + ".tmp";
+	bool result;
+	{
+		Writer w(temp.c_str());
+		result = w.write(box);
+	}
+
+	std::error_code e;
+	if (result)
+		std::filesystem::rename(temp, path, e);
+	if (!result || e)
+	{
+		std::filesystem::remove(temp, e);
+		return false;
+	}
+	return true;
+}
+
+inline bool DataView::open(const char* path, DataMapMode mode)
+{
+	if (!m_file.open(path, mode))
+		return false;
+
+	// HƂɊm߂Ȃčςނ悤AJƂɑSĂ̕\m߂
+	const Header* h = reinterpret_cast<const Header*>(m_file.data());
+	if (m_file.size() < sizeof(Header)
+		|| memcmp(h->magic, "FDAV", 4) != 0
+		|| h->version != VERSION
+		|| h->size != m_file.size()
+		|| !valid(h->root, h->size))
+	{
+		m_file.close();
+		return false;
+	}
+	return true;
+}
+
+inline void DataView::close()
+{
+	m_file.close();
+}
+
+inline DataBoxView DataView::root() const
+{
+	if (!m_file.data())
+		throw std::logic_error("DataView: not open");
+
+	const Header* h = reinterpret_cast<const Header*>(m_file.data());
+	return DataBoxView(m_file.data(), reinterpret_cast<const BoxRecord*>(m_file.data() + h->root));
+}
+
+inline DataBox DataView::map()
+{
+	if (!m_file.writableData())
+		throw std::logic_error("DataView: not open writable");
+
+	return map(root());
+}
+
+inline const DataMappedFile& DataView::file() const
+{
+	return m_file;
+}
+
+inline DataBox DataView::map(const DataBoxView& view)
+{
+	DataBox box;
+	for (size_t i = 0; i < view.itemCount(); ++i)
+	{
+		DataItemView item = view.itemAt(i);
+		if (item.getElementCount() == 0)
+		{
+			box.add(view.itemNameAt(i), item.item());
+			continue;
+		}
+
+		size_t offset = static_cast<size_t>(static_cast<const char*>(item.getElementPointer()) - m_file.data());
+		box.add(view.itemNameAt(i), DataItem::createFromMapping(m_file, offset, item.getElementSize(), item.getElementCount(), item.getFormat()));
+	}
+	for (size_t i = 0; i < view.boxCount(); ++i)
+		box.add(view.boxNameAt(i), map(view.boxAt(i)));
+	return box;
+}
+
+inline bool DataView::valid(uint64_t box, uint64_t limit) const
+{
+	uint64_t size = m_file.size();
+	if (box % 8 != 0 || box < sizeof(Header) || box >= limit || size - box < sizeof(BoxRecord))
+		return false;
+
+	const BoxRecord* r = reinterpret_cast<const BoxRecord*>(m_file.data() + box);
+	uint64_t table = uint64_t(r->itemCount) * sizeof(ItemEntry) + uint64_t(r->boxCount) * sizeof(BoxEntry);
+	if (size - box - sizeof(BoxRecord) < table)
+		return false;
+
+	// l͎g̕\OɏoĂ
+	const ItemEntry* items = reinterpret_cast<const ItemEntry*>(r + 1);
+	for (uint32_t i = 0; i < r->itemCount; ++i)
+	{
+		const ItemEntry& e = items[i];
+		if (!validName(e.name, e.nameLength))
+			return false;
+		if (e.elementSize != 1 && e.elementSize != 2 && e.elementSize != 4 && e.elementSize != 8)
+			return false;
+		if (e.format > static_cast<uint32_t>(DataFormat::PACKED))
+			return false;
+		uint64_t count = e.elementCount == 0 ? 1 : e.elementCount;
+		if (e.payload % 8 != 0 || e.payload > box || count > (box - e.payload) / e.elementSize)
+			return false;
+	}
+
+	const BoxEntry* boxes = reinterpret_cast<const BoxEntry*>(items + r->itemCount);
+	for (uint32_t i = 0; i < r->boxCount; ++i)
+	{
+		if (!validName(boxes[i].name, boxes[i].nameLength) || !valid(boxes[i].box, box))
+			return false;
+	}
+	return true;
+}
+
+inline bool DataView::validName(uint64_t name, uint64_t length) const
+{
+	uint64_t size = m_file.size();
+	return name <= size && length < size - name && m_file.data()[name + length] == '\0';
+}
+
+inline DataItemView::DataItemView(const char* base, const DataView::ItemEntry* entry)
+	: m_base(base)
+	, m_entry(entry)
+{
+}
+
+inline std::string DataItemView::operator()() const
+{
+	std::string text;
+	DataItem::appendFormat(text, getFormat(), getElementSize(), getElementCount(), getElementPointer());
+	return text;
+}
+
+template<typename T>
+inline DataItemView::operator T() const
+{
+	static_assert(!std::is_pointer_v<T> && !std::is_array_v<T>, "|C^Ez͖");
+
+	if (std::alignment_of_v<T> != m_entry->elementSize)
+		throw std::runtime_error("DataItemView: type mismatch");
+
+	return *static_cast<const T*>(getElementPointer());
+}
+
+template<typename T>
+inline DataItemView::operator const T* () const
+{
+	static_assert(!std::is_pointer_v<T> && !std::is_array_v<T>, "|C^Ez͖");
+
+	if (std::alignment_of_v<T> != m_entry->elementSize)
+		throw std::runtime_error("DataItemView: type mismatch");
+
+	return static_cast<const T*>(getElementPointer());
+}
+
+inline DataItem DataItemView::item() const
+{
+	return DataItem::createFromMemory(getElementSize(), getElementCount(), getFormat(), getElementPointer());
+}
+
+inline size_t DataItemView::getElementSize() const
+{
+	return m_entry->elementSize;
+}
+
+inline size_t DataItemView::getElementCount() const
+{
+	return static_cast<size_t>(m_entry->elementCount);
+}
+
+inline DataFormat DataItemView::getFormat() const
+{
+	return static_cast<DataFormat>(m_entry->format);
+}
+
+inline const void* DataItemView::getElementPointer() const
+{
+	return m_base + m_entry->payload;
+}
+
+inline DataBoxView::DataBoxView(const char* base, const DataView::BoxRecord* box)
+	: m_base(base)
+	, m_box(box)
+{
+}
+
+inline DataBoxView DataBoxView::operator[](const char* path) const
+{
+	const DataView::BoxEntry* e = findBox(path);
+	if (!e)
+		throw std::out_of_range("DataBoxView: box not found");
+	return DataBoxView(m_base, reinterpret_cast<const DataView::BoxRecord*>(m_base + e->box));
+}
+
+inline DataItemView DataBoxView::operator()(const char* path) const
+{
+	const DataView::ItemEntry* e = findItem(path);
+	if (!e)
+		throw std::out_of_range("DataBoxView: item not found");
+	return DataItemView(m_base, e);
+}
+
+inline bool DataBoxView::box(const char* path) const
+{
+	return findBox(path) != nullptr;
+}
+
+inline bool DataBoxView::item(const char* path) const
+{
+	return findItem(path) != nullptr;
+}
+
+inline size_t DataBoxView::boxCount() const
+{
+	return m_box->boxCount;
+}
+
+inline size_t DataBoxView::itemCount() const
+{
+	return m_box->itemCount;
+}
+
+inline const char* DataBoxView::boxNameAt(size_t index) const
+{
+	return m_base + boxes()[index].name;
+}
+
+inline DataBoxView DataBoxView::boxAt(size_t index) const
+{
+	return DataBoxView(m_base, reinterpret_cast<const DataView::BoxRecord*>(m_base + boxes()[index].box));
+}
+
+inline const char* DataBoxView::itemNameAt(size_t index) const
+{
+	return m_base + items()[index].name;
+}
+
+inline DataItemView DataBoxView::itemAt(size_t index) const
+{
+	return DataItemView(m_base, items() + index);
+}
+
+inline uint64_t DataBoxView::hash() const
+{
+	return m_box->hash;
+}
+
+inline DataBox DataBoxView::load() const
+{
+	DataBox box;
+	for (size_t i = 0; i < itemCount(); ++i)
+		box.add(itemNameAt(i), itemAt(i).item());
+	for (size_t i = 0; i < boxCount(); ++i)
+		box.add(boxNameAt(i), boxAt(i).load());
+	return box;
+}
+
+inline const DataView::ItemEntry* DataBoxView::items() const
+{
+	return reinterpret_cast<const DataView::ItemEntry*>(m_box + 1);
+}
+
+inline const DataView::BoxEntry* DataBoxView::boxes() const
+{
+	return reinterpret_cast<const DataView::BoxEntry*>(items() + m_box->itemCount);
+}
+
+inline const DataView::ItemEntry* DataBoxView::findItem(const char* path) const
+{
+	// Oɕł̂œ񕪒T
+	std::string_view key(path);
+	const DataView::ItemEntry* e = items();
+	size_t l = 0;
+	size_t r = m_box->itemCount;
+	while (l < r)
+	{
+		size_t m = (l + r) / 2;
+		int c = std::string_view(m_base + e[m].name, e[m].nameLength).compare(key);
+		if (c == 0)
+			return e + m;
+		if (c < 0)
+			l = m + 1;
+		else
+			r = m;
+	}
+	return nullptr;
+}
+
+inline const DataView::BoxEntry* DataBoxView::findBox(const char* path) const
+{
+	std::string_view key(path);
+	const DataView::BoxEntry* e = boxes();
+	size_t l = 0;
+	size_t r = m_box->boxCount;
+	while (l < r)
+	{
+		size_t m = (l + r) / 2;
+		int c = std::string_view(m_base + e[m].name, e[m].nameLength).compare(key);
+		if (c == 0)
+			return e + m;
+		if (c < 0)
+			l = m + 1;
+		else
+			r = m;
+	}
+	return nullptr;
+}
+
+inline DataView::Writer::Writer(const char* path)
+	: m_file(path, std::ios::out | std::ios::binary)
+	, m_position()
+{
+}
+
+inline bool DataView::Writer::write(const DataBox& box)
+{
+	if (!m_file)
+		return false;
+
+	// wb_͍Ōɏ
+	Header h = {{'F', 'D', 'A', 'V'}, VERSION, 0, 0};
+	bytes(&h, sizeof(h));
+
+	h.root = this->box(box);
+	h.size = m_position;
+
+	m_file.seekp(0);
+	m_file.write(reinterpret_cast<const char*>(&h), sizeof(h));
+	m_file.close();
+	return !m_file.fail();
+}
+
+inline uint64_t DataView::Writer::box(const DataBox& box)
+{
+	std::vector<ItemEntry> items;
+	std::vector<BoxEntry> boxes;
+	items.reserve(box.items().size());
+	boxes.reserve(box.boxes().size());
+
+	// O̓kI[ďôł̂܂const char*ƂĎg
+	for (auto& i : box.items())
+	{
+		ItemEntry e = {};
+		e.name = bytes(i.first.c_str(), i.first.size() + 1);
+		e.nameLength = static_cast<uint32_t>(i.first.size());
+		e.elementSize = static_cast<uint32_t>(i.second.getElementSize());
+		e.elementCount = i.second.getElementCount();
+		e.format = static_cast<uint32_t>(i.second.getFormat());
+		align();
+		e.payload = bytes(i.second.getElementPointer(), e.elementSize * (e.elementCount == 0 ? 1 : e.elementCount));
+		items.push_back(e);
+	}
+
+	for (auto& i : box.boxes())
+	{
+		BoxEntry e = {};
+		e.name = bytes(i.first.c_str(), i.first.size() + 1);
+		e.nameLength = static_cast<uint32_t>(i.first.size());
+		e.box = this->box(i.second);
+		boxes.push_back(e);
+	}
+
+	align();
+	BoxRecord r = {static_cast<uint32_t>(items.size()), static_cast<uint32_t>(boxes.size()), box.hash()};
+	uint64_t p = bytes(&r, sizeof(r));
+	if (!items.empty())
+		bytes(items.data(), sizeof(ItemEntry) * items.size());
+	if (!boxes.empty())
+		bytes(boxes.data(), sizeof(BoxEntry) * boxes.size());
+	return p;
+}
+
+inline uint64_t DataView::Writer::bytes(const void* data, size_t size)
+{
+	uint64_t p = m_position;
+	m_file.write(static_cast<const char*>(data), size);
+	m_position += size;
+	return p;
+}
+
+inline void DataView::Writer::align()
+{
+	static const char zero[8] = {};
+	size_t n = static_cast<size_t>((8 - m_position % 8) % 8);
+	if (n > 0)
+		bytes(zero, n);
+}
@@ -0,0 +1,516 @@
+#pragma once
+
+#include "DataParser.h"
+#include "DataPatch.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <mbstring.h>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+/// <summary>
+/// <para>t@C̕ύXĎDataBoxɔfNX</para>
+/// <para>ŏʂDataBoxDataItemƂɃt@C̃̕nbVloĂA</para>
+/// <para>ς̂͂čւ̂ŁAēǂݍ݂̎Ԃ͕ҏW̑傫Ō܂</para>
+/// <para>ύX̌mƉ͂͊ĎXbhōsADataBoxւ̔fupdate()Ă񂾃Xbhōs</para>
+/// <para>ύX̌mɂWindowsł̓fBNg̕ύXʒmALinuxłinotifygAȊO͈ԊuŒׂ</para>
+/// </summary>
+class DataWatcher
+{
+public:
+	/// <summary>
+	/// <para>ύXꂽpX('/'؂)̈ꗗ󂯎֐</para>
+	/// </summary>
+	using Callback = std::function<void(const std::vector<std::string>& paths)>;
+
+public:
+	/// <summary>
+	/// <para>Ďt@CƔfDataBoxݒ肷</para>
+	/// <para>ŏreload()܂update()Ŋ̏Ԓl͑Sď</para>
+	/// </summary>
+	DataWatcher(DataBox& box, const char* path);
+	~DataWatcher();
+
+	DataWatcher(const DataWatcher&) = delete;
+	DataWatcher& operator=(const DataWatcher&) = delete;
+
+public:
+	/// <summary>
+	/// <para>ĎXbhN</para>
+	/// </summary>
+	/// <param name="interval">ύXʒmȂꍇɃt@C𒲂ׂԊu (~܂ł̍ő̑҂Ԃł)</param>
+	void start(std::chrono::milliseconds interval = std::chrono::milliseconds(200));
+
+	/// <summary>
+	/// <para>ĎXbh~</para>
+	/// </summary>
+	void stop();
+
+	/// <summary>
+	/// <para>ĎXbh͂ύXDataBoxɔfAwǎ҂ɒʒm</para>
+	/// <para>DataBoxgXbhIɌĂԂ</para>
+	/// </summary>
+	/// <returns>true=ύX</returns>
+	bool update();
+
+	/// <summary>
+	/// <para>ĎXbhg킸ɁAɃt@C𒲂ׂĕύX𔽉f</para>
+	/// </summary>
+	/// <returns>true=ύX</returns>
+	bool reload();
+
+	/// <summary>
+	/// <para>ύX̒ʒm󂯎֐o^</para>
+	/// </summary>
+	/// <returns>unsubscribe()ɓnID</returns>
+	size_t subscribe(Callback callback);
+
+	/// <summary>
+	/// <para>o^֐</para>
+	/// </summary>
+	void unsubscribe(size_t id);
+
+private:
+	/// <summary>
+	/// <para>ŏʂ1DataBox܂DataItem̕ύX</para>
+	/// <para>boxitemȂꍇ͍폜</para>
+	/// </summary>
+	struct Change
+	{
+		std::string name;
+		bool isBox;
+		std::optional<DataBox> box;
+		std::optional<DataItem> item;
+	};
+
+	bool scan(std::vector<Change>& changes);
+	bool apply(std::vector<Change>& changes);
+	void run(std::chrono::milliseconds interval);
+
+	static size_t find(const std::string& text, size_t start, char sbc);
+
+private:
+	DataBox& m_box;
+	std::string m_path;
+
+	std::mutex m_scanMutex;
+	bool m_loaded;
+	uint64_t m_fileHash;
+	std::map<std::string, uint64_t, std::less<>> m_boxHashes;
+	std::map<std::string, uint64_t, std::less<>> m_itemHashes;
+
+	std::mutex m_pendingMutex;
+	std::vector<Change> m_pending;
+
+	std::map<size_t, Callback> m_callbacks;
+	size_t m_nextId;
+
+	std::thread m_thread;
+	std::atomic<bool> m_stop;
+};
+
+
+
+
+inline DataWatcher::DataWatcher(DataBox& box, const char* path)
+	: m_box(box)
+	, m_path(path)
+	, m_scanMutex()
+	, m_loaded()
+	, m_fileHash()
+	, m_boxHashes()
+	, m_itemHashes()
+	, m_pendingMutex()
+	, m_pending()
+	, m_callbacks()
+	, m_nextId()
+	, m_thread()
+	, m_stop()
+{
+}
+
+inline DataWatcher::~DataWatcher()
+{
+	stop();
+}
+
+inline void DataWatcher::start(std::chrono::milliseconds interval)
+{
+	stop();
+	m_stop = false;
+	m_thread = std::thread(&DataWatcher::run, this, interval);
+}
+
+inline void DataWatcher::stop()
+{
+	m_stop = true;
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+inline bool DataWatcher::update()
+{
+	std::vector<Change> changes;
+	{
+		std::lock_guard<std::mutex> lock(m_pendingMutex);
+		changes.swap(m_pending);
+	}
+	return apply(changes);
+}
+
+inline bool DataWatcher::reload()
+{
+	std::vector<Change> changes;
+	scan(changes);
+
+	// ĎXbhɉ͂ύX΁Aɔf
+	{
+		std::lock_guard<std::mutex> lock(m_pendingMutex);
+		for (auto& i : changes)
+			m_pending.push_back(std::move(i));
+	}
+	return update();
+}
+
+inline size_t DataWatcher::subscribe(Callback callback)
+{
+	m_callbacks.emplace(m_nextId, std::move(callback));
+	return m_nextId++;
+}
+
+inline void DataWatcher::unsubscribe(size_t id)
+{
+	m_callbacks.erase(id);
+}
+
+inline bool DataWatcher::scan(std::vector<Change>& changes)
+{
+	std::lock_guard<std::mutex> lock(m_scanMutex);
+
+	std::string text;
+	{
+		std::ifstream o(m_path, std::ios::in);
+		if (!o)
+			return false;
+		text.assign((std::istreambuf_iterator<char>(o)), std::istreambuf_iterator<char>());
+	}
+
+	// t@CŜςĂȂΉȂ
+	uint64_t fileHash = DataHash::bytes(text.data(), text.size());
+	if (m_loaded && fileHash == m_fileHash)
+		return false;
+
+	// ŏʂ̃^O؂Ag̃̕nbVlς̂͂
+	// ݓrȂǂŏԈĂꍇ́A͉̕ύX҂
+	std::vector<Change> result;
+	std::map<std::string, uint64_t, std::less<>> boxHashes;
+	std::map<std::string, uint64_t, std::less<>> itemHashes;
+	if (!m_loaded)
+		result.push_back(Change{std::string(), true, std::nullopt, std::nullopt});
+	try
+	{
+		size_t i = 0;
+		while (i < text.size())
+		{
+			if (_mbclen(reinterpret_cast<const unsigned char*>(text.c_str() + i)) == 2)
+			{
+				i += 2;
+				continue;
+			}
+
+			// (DataItemName)Value
+			if (text[i] == '(')
+			{
+				size_t j = find(text, i + 1, ')');
+				size_t k = text.find('\n', j + 1);
+				if (k == std::string::npos)
+					k = text.size();
+				std::string name = text.substr(i + 1, j - i - 1);
+				std::string value = text.substr(j + 1, k - j - 1);
+				if (!value.empty() && value.back() == '\r')
+					value.pop_back();
+
+				uint64_t h = DataHash::bytes(value.data(), value.size());
+				itemHashes[name] = h;
+				auto p = m_itemHashes.find(name);
+				if (!m_loaded || p == m_itemHashes.end() || p->second != h)
+					result.push_back(Change{name, false, std::nullopt, DataItem::createFromFormat(value.c_str())});
+				i = k;
+			}
+
+			// [DataBoxName] ` [/DataBoxName]
+			else if (text[i] == '[')
+			{
+				size_t j = find(text, i + 1, ']');
+				std::string name = text.substr(i + 1, j - i - 1);
+				if (!name.empty() && name[0] == '/')
+					throw std::runtime_error("DataWatcher: unexpected " + name);
+
+				// q𐔂ȂΉ^OT
+				size_t depth = 1;
+				size_t k = j + 1;
+				size_t l = k;
+				while (depth > 0)
+				{
+					if (k >= text.size())
+						throw std::runtime_error("DataWatcher: box is not closed " + name);
+					if (_mbclen(reinterpret_cast<const unsigned char*>(text.c_str() + k)) == 2)
+					{
+						k += 2;
+						continue;
+					}
+					if (text[k] == '(')
+					{
+						// l̒̊ʂ͐Ȃ
+						k = text.find('\n', find(text, k + 1, ')'));
+						if (k == std::string::npos)
+							k = text.size();
+						continue;
+					}
+					if (text[k] == '[')
+					{
+						l = find(text, k + 1, ']');
+						if (text[k + 1] == '/')
+							--depth;
+						else
+							++depth;
+						if (depth > 0)
+							k = l;
+						continue;
+					}
+					++k;
+				}
+
+				// ̏
+				// i           j      k            l
+				// [DataBoxName] () [/DataBoxName]
+				uint64_t h = DataHash::bytes(text.data() + j + 1, k - j - 1);
+				boxHashes[name] = h;
+				auto p = m_boxHashes.find(name);
+				if (!m_loaded || p == m_boxHashes.end() || p->second != h)
+				{
+					Change c = {name, true, DataBox(), std::nullopt};
+					DataParser parser(*c.box);
+					parser.feed(text.data() + j + 1, k - j - 1);
+					parser.finish();
+					result.push_back(std::move(c));
+				}
+				i = l;
+			}
+
+			++i;
+		}
+	}
+	catch (const std::exception&)
+	{
+		return false;
+	}
+
+	// t@C
+	for (auto& p : m_itemHashes)
+	{
+		if (itemHashes.find(p.first) == itemHashes.end())
+			result.push_back(Change{p.first, false, std::nullopt, std::nullopt});
+	}
+	for (auto& p : m_boxHashes)
+	{
+		if (boxHashes.find(p.first) == boxHashes.end())
+			result.push_back(Change{p.first, true, std::nullopt, std::nullopt});
+	}
+
+	m_loaded = true;
+	m_fileHash = fileHash;
+	m_boxHashes.swap(boxHashes);
+	m_itemHashes.swap(itemHashes);
+	for (auto& c : result)
+		changes.push_back(std::move(c));
+	return true;
+}
+
+inline bool DataWatcher::apply(std::vector<Change>& changes)
+{
+	std::vector<std::string> paths;
+	for (auto& c : changes)
+	{
+		// O̍폜͍ŏ̓ǂݍ݂Ŋ̏Ԓlw
+		if (c.name.empty() && !c.box && !c.item)
+		{
+			m_box.clear();
+			continue;
+		}
+
+		if (!c.isBox)
+		{
+			if (c.item)
+			{
+				if (m_box.item(c.name) && m_box(c.name).hash() == c.item->hash())
+					continue;
+				m_box.add(c.name, std::move(*c.item));
+				paths.push_back(c.name);
+			}
+			else if (m_box.removeItem(c.name))
+				paths.push_back(c.name);
+			continue;
+		}
+
+		if (!c.box)
+		{
+			if (m_box.removeBox(c.name))
+				paths.push_back(c.name);
+			continue;
+		}
+
+		// DataBoxƔׂāAۂɕςpXʒm
+		if (m_box.box(c.name))
+		{
+			DataPatch patch = DataPatch::diff(m_box[c.name], *c.box);
+			if (patch.empty())
+				continue;
+			for (auto& o : patch.operations())
+				paths.push_back(c.name + '/' + o.path);
+		}
+		else
+			paths.push_back(c.name);
+		m_box.add(c.name, std::move(*c.box));
+	}
+
+	if (paths.empty())
+		return false;
+	for (auto& i : m_callbacks)
+		i.second(paths);
+	return true;
+}
+
+inline void DataWatcher::run(std::chrono::milliseconds interval)
+{
+	std::filesystem::path file = std::filesystem::absolute(m_path);
+	std::filesystem::path dir = file.parent_path();
+	std::filesystem::file_time_type scannedTime = {};
+	std::filesystem::file_time_type seenTime = {};
+	uintmax_t scannedSize = 0;
+	uintmax_t seenSize = 0;
+	bool force = false;
+
+	// ύXʒm͑҂ԂZ邽߂ɎgAύX̗L͍XVƃTCYŔf
+#ifdef _WIN32
+	HANDLE h = FindFirstChangeNotificationA(dir.string().c_str(), FALSE,
+		FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE);
+#elif defined(__linux__)
+	int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fd >= 0 && inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MODIFY) < 0)
+	{
+		close(fd);
+		fd = -1;
+	}
+	std::string name = file.filename().string();
+#endif
+
+	while (!m_stop)
+	{
+		// ݓr̃t@Cǂ܂Ȃ悤ɁAXVƃTCY1񕪂̊ԊůԕςȂȂĂǂݍ
+		// ݂IƂꍇ͂ɓǂݍ
+		std::error_code e1;
+		std::error_code e2;
+		auto t = std::filesystem::last_write_time(file, e1);
+		auto s = std::filesystem::file_size(file, e2);
+		if (!e1 && !e2)
+		{
+			bool changed = t != scannedTime || s != scannedSize;
+			bool stable = t == seenTime && s == seenSize;
+			if (force || (changed && stable))
+			{
+				std::vector<Change> changes;
+				if (scan(changes))
+				{
+					std::lock_guard<std::mutex> lock(m_pendingMutex);
+					for (auto& i : changes)
+						m_pending.push_back(std::move(i));
+				}
+				scannedTime = t;
+				scannedSize = s;
+			}
+			seenTime = t;
+			seenSize = s;
+		}
+		force = false;
+
+#ifdef _WIN32
+		if (h != INVALID_HANDLE_VALUE)
+		{
+			if (WaitForSingleObject(h, static_cast<DWORD>(interval.count())) == WAIT_OBJECT_0)
+				FindNextChangeNotification(h);
+			continue;
+		}
+#elif defined(__linux__)
+		if (fd >= 0)
+		{
+			// ĎΏۂ̃t@CꂽEuꂽꍇ́AETCYłKǂݍ
+			pollfd p = {fd, POLLIN, 0};
+			if (poll(&p, 1, static_cast<int>(interval.count())) > 0)
+			{
+				alignas(inotify_event) char buffer[4096];
+				ssize_t n;
+				while ((n = read(fd, buffer, sizeof(buffer))) > 0)
+				{
+					for (char* i = buffer; i < buffer + n; i += sizeof(inotify_event) + reinterpret_cast<inotify_event*>(i)->len)
+					{
+						inotify_event* event = reinterpret_cast<inotify_event*>(i);
+						if (event->len > 0 && name == event->name && (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)))
+							force = true;
+					}
+				}
+			}
+			continue;
+		}
+#endif
+		std::this_thread::sleep_for(interval);
+	}
+
+#ifdef _WIN32
+	if (h != INVALID_HANDLE_VALUE)
+		FindCloseChangeNotification(h);
+#elif defined(__linux__)
+	if (fd >= 0)
+		close(fd);
+#endif
+}
+
+inline size_t DataWatcher::find(const std::string& text, size_t start, char sbc)
+{
+	// SppȂw肵pT
+	while (true)
+	{
+		if (start >= text.size())
+			throw std::runtime_error(std::string("DataWatcher: not found ") + sbc);
+		if (_mbclen(reinterpret_cast<const unsigned char*>(text.c_str() + start)) == 2)
+		{
+			start += 2;
+			continue;
+		}
+		if (text[start] == sbc)
+			return start;
+		++start;
+	}
+}
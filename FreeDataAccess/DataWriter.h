@@ -0,0 +1,278 @@
+#pragma once
+
+#include "DataItem.h"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+
+/// <summary>
+/// <para>DataBox̖؂炸DataBox̃t@C擪珇ɏoNX</para>
+/// <para>oeDataBox::outputFile()ƓŁADataBox::inputFile()DataReaderœǂ߂</para>
+/// <para>lDataItem::operator()()ƓKŏ</para>
+/// <para>oԂ͌ĂяoԂɂȂ</para>
+/// <para>DataBox::outputFile()ƑSeɂꍇAeDataBox̒</para>
+/// <para>DataItem𖼑OɏĂDataBox𖼑Oɏ</para>
+/// <para>gpʂ̓obt@TCYƓq̐[Ō܂</para>
+/// </summary>
+class DataWriter
+{
+public:
+	/// <param name="bufferSize">t@C֏ޑOɗ߂Ăobt@̃TCY</param>
+	/// <param name="style">o͂̏</param>
+	explicit DataWriter(size_t bufferSize = 64 * 1024, DataOutputStyle style = DataOutputStyle::INDENTED);
+
+	/// <summary>
+	/// <para>JĂt@CΕ</para>
+	/// </summary>
+	~DataWriter();
+
+	DataWriter(const DataWriter&) = delete;
+	DataWriter& operator=(const DataWriter&) = delete;
+
+public:
+	/// <summary>
+	/// <para>t@CJ</para>
+	/// <para>ɊJĂt@C͕</para>
+	/// </summary>
+	/// <param name="path">o̓t@CpX</param>
+	/// <returns>true=, false=s</returns>
+	bool open(const char* path);
+
+	/// <summary>
+	/// <para>obt@̓eŃt@C</para>
+	/// <para>ĂȂDataBoxΗO</para>
+	/// </summary>
+	/// <returns>true=, false=s</returns>
+	bool close();
+
+	/// <summary>
+	/// <para>[DataBoxName]oDataBoxJ</para>
+	/// </summary>
+	void beginBox(const char* name);
+
+	/// <summary>
+	/// <para>[/DataBoxName] (MINIFIED̏ꍇ[/]) oĒOɊJDataBox</para>
+	/// <para>JĂDataBoxȂΗO</para>
+	/// </summary>
+	void endBox();
+
+	/// <summary>
+	/// <para>DȒlDataItemo</para>
+	/// </summary>
+	template<typename T>
+	void item(const char* name, T element);
+
+	/// <summary>
+	/// <para>zDataItemo</para>
+	/// </summary>
+	/// <param name="elementPointer">z̐擪̃|C^</param>
+	/// <param name="elementCount">z̗vf</param>
+	template<typename T>
+	void item(const char* name, const T* elementPointer, size_t elementCount);
+
+	/// <summary>
+	/// <para>kI[DataItemo</para>
+	/// </summary>
+	void item(const char* name, const char* text);
+
+	/// <summary>
+	/// <para>DataItemo</para>
+	/// </summary>
+	void item(const char* name, const DataItem& item);
+
+	/// <returns>݊JĂDataBox̓q̐[</returns>
+	size_t depth() const;
+
+private:
+	void beginItem(const char* name);
+	void endItem();
+	void indent();
+	void flushIfFull();
+	bool flush();
+
+private:
+	std::ofstream m_file;
+	std::string m_buffer;
+	size_t m_bufferSize;
+	DataOutputStyle m_style;
+
+	std::string m_names;
+	std::vector<size_t> m_nameEnds;
+};
+
+
+
+
+inline DataWriter::DataWriter(size_t bufferSize, DataOutputStyle style)
+	: m_file()
+	, m_buffer()
+	, m_bufferSize(bufferSize)
+	, m_style(style)
+	, m_names()
+	, m_nameEnds()
+{
+}
+
+inline DataWriter::~DataWriter()
+{
+	if (m_file.is_open())
+	{
+		flush();
+		m_file.close();
+	}
+}
+
+inline bool DataWriter::open(const char* path)
+{
+	if (m_file.is_open())
+	{
+		flush();
+		m_file.close();
+	}
+	m_file.clear();
+	m_buffer.clear();
+	m_names.clear();
+	m_nameEnds.clear();
+
+	m_file.open(path, std::ios::out);
+	if (!m_file)
+		return false;
+
+	m_buffer.reserve(m_bufferSize);
+	return true;
+}
+
+inline bool DataWriter::close()
+{
+	if (!m_nameEnds.empty())
+		throw std::logic_error("DataWriter: box is not closed");
+
+	if (!m_file.is_open())
+		return false;
+
+	bool r = flush();
+	m_file.close();
+	return r && !m_file.fail();
+}
+
+inline void DataWriter::beginBox(const char* name)
+{
+	indent();
+	m_buffer += '[';
+	m_buffer.append(name);
+	m_buffer.append("]\n");
+
+	m_names.append(name);
+	m_nameEnds.push_back(m_names.size());
+
+	flushIfFull();
+}
+
+inline void DataWriter::endBox()
+{
+	if (m_nameEnds.empty())
+		throw std::logic_error("DataWriter: no box to close");
+
+	size_t e = m_nameEnds.back();
+	size_t s = m_nameEnds.size() >= 2 ? m_nameEnds[m_nameEnds.size() - 2] : 0;
+	m_nameEnds.pop_back();
+
+	indent();
+	if (m_style == DataOutputStyle::MINIFIED)
+	{
+		m_buffer.append("[/]\n");
+	}
+	else
+	{
+		m_buffer.append("[/");
+		m_buffer.append(m_names, s, e - s);
+		m_buffer.append("]\n");
+	}
+
+	m_names.resize(s);
+
+	flushIfFull();
+}
+
+template<typename T>
+inline void DataWriter::item(const char* name, T element)
+{
+	static_assert(!std::is_pointer_v<T> && !std::is_array_v<T>, "|C^Ez͖");
+
+	beginItem(name);
+	DataItem::appendFormat(m_buffer, DataItem::getDefaultFormat<T>(), std::alignment_of_v<T>, 0, &element);
+	endItem();
+}
+
+template<typename T>
+inline void DataWriter::item(const char* name, const T* elementPointer, size_t elementCount)
+{
+	beginItem(name);
+	DataItem::appendFormat(m_buffer, DataItem::getDefaultFormat<T>(), std::alignment_of_v<T>, elementCount, elementPointer);
+	endItem();
+}
+
+inline void DataWriter::item(const char* name, const char* text)
+{
+	// DataItem(const char*)Ɠk܂Ŋ܂߂zƂĈ
+	size_t c = 0;
+	while (text[c] != '\0') ++c;
+	++c;
+
+	beginItem(name);
+	DataItem::appendFormat(m_buffer, DataItem::getDefaultFormat<char>(), sizeof(char), c, text);
+	endItem();
+}
+
+inline void DataWriter::item(const char* name, const DataItem& item)
+{
+	beginItem(name);
+	m_buffer.append(item());
+	endItem();
+}
+
+inline size_t DataWriter::depth() const
+{
+	return m_nameEnds.size();
+}
+
+inline void DataWriter::beginItem(const char* name)
+{
+	indent();
+	m_buffer += '(';
+	m_buffer.append(name);
+	m_buffer += ')';
+}
+
+inline void DataWriter::endItem()
+{
+	m_buffer += '\n';
+	flushIfFull();
+}
+
+inline void DataWriter::indent()
+{
+	if (m_style == DataOutputStyle::MINIFIED)
+		return;
+	m_buffer.append(m_nameEnds.size() * 2, ' ');
+}
+
+inline void DataWriter::flushIfFull()
+{
+	if (m_buffer.size() >= m_bufferSize)
+		flush();
+}
+
+inline bool DataWriter::flush()
+{
+	if (m_buffer.empty())
+		return true;
+
+	FDA_TRACE_PHASE(DataTracePhase::WRITE);
+
+	m_file.write(m_buffer.c_str(), m_buffer.size());
+	m_buffer.clear();
+	return !m_file.fail();
+}
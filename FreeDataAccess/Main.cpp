@@ -1,5 +1,10 @@
 #include <iostream>
+#include <thread>
+#include <vector>
+#include "DataAggregate.h"
 #include "DataBox.h"
+#include "DataReader.h"
+#include "DataSplitFile.h"
 
 int main(void)
 {
@@ -27,7 +32,8 @@ int main(void)
 	* @@@1="M["
 	* @@@2="nCIN"
 	* @@@3="y"
-	* @@@K\={1,2,3}
+	* @@@K\={1,2,3}
+	* @@@="[]͍"
 	* @@s@={false,true,true,false}
 	*/
 	DataBox thing;
@@ -72,6 +78,8 @@ int main(void)
 			car.add("3", DataItem("y"));
 			int gasoline[] = {1, 2, 3};
 			car.add("K\", DataItem(gasoline, 3));
+			// ̒lɂ[]܂߂Ă悢
+			car.add("", DataItem("[]͍"));
 			vehicle.add("", std::move(car));
 		}
 		{
@@ -92,6 +100,37 @@ int main(void)
 		thing2.outputFile("data2.txt");
 	}
 
+	// ꕔDataBoxʂ̃t@Cɕēo͂邱Ƃł
+	// oƂ͕ςDataBox̃t@C
+	{
+		DataSplitFile split;
+		split.split({"Hו"}, "food.txt");
+		split.split({"蕨"}, "vehicle.txt");
+		split.outputFile(thing, "split.txt");
+
+		DataBox thing2;
+		DataSplitFile split2;
+		split2.inputFile(thing2, "split.txt");
+		thing2["Hו"]["ʕ"][""]("ۂ") = false;
+		split2.outputFile(thing2, "split.txt");
+		std::cout << "t@C̐=" << split2.written() << std::endl;
+	}
+
+	// ؂炸Ƀt@C擪珇ɓǂނƂł
+	// ȃt@Cꕔ̒loƂɎg
+	{
+		DataReader reader;
+		reader.open("data.txt");
+		while (reader.next() != DataReaderEvent::END)
+		{
+			// KvȂDataBox͒g𐶐ɓǂݔ΂
+			if (reader.name() == "蕨")
+				reader.skipBox();
+			else if (reader.name() == "F")
+				std::cout << "񂲂̐F=" << reader.value() << std::endl;
+		}
+	}
+
 	// operator[]BoxHAoperator()Item擾
 	// ŌItemoperator()Item̒l𕶎ɂďo
 	std::cout << "񂲂̐F=" << thing["Hו"]["ʕ"][""]("F")() << std::endl;
@@ -151,5 +190,55 @@ int main(void)
 	plane.shallow(ary, 3);
 	std::cout << plane() << std::endl;
 
+	// lDataItemDataInternPoolɓo^1̒lL
+	// o^Ɖ͕̃Xbh瓯ɍsĂ悢
+	{
+		DataInternPool pool;
+		std::vector<std::thread> threads;
+		for (int t = 0; t < 4; ++t)
+		{
+			threads.emplace_back([&pool, t]()
+			{
+				DataBox box;
+				for (int i = 0; i < 1000; ++i)
+					box.add(std::to_string(i), DataItem(i % 10));
+				box.intern(pool);
+
+				// LĂlƁAOɎg̒lRs[
+				for (int i = 0; i < 1000; i += 2)
+					box(std::to_string(i)) = i + t;
+			});
+		}
+		for (auto& i : threads)
+			i.join();
+
+		// SĂDataItemjꂽ̂ŁAv[͋ɂȂĂ
+		std::cout << "LĂl̎=" << pool.size() << std::endl;
+	}
+
+	// qDataBoxODataItem܂Ƃ߂ďWvł
+	{
+		DataBox shop;
+		for (int i = 0; i < 100; ++i)
+		{
+			DataBox day;
+			day.add("", DataItem(i * 10));
+			shop.add(std::to_string(i), std::move(day));
+		}
+		DataStats<int32_t> sales = DataAggregate::stats<int32_t>(shop, "");
+		std::cout << "̍v=" << sales.sum << " ő=" << sales.max << std::endl;
+
+		// ^̃TCYႤDataItemƗOo
+		shop.add("", DataItem(static_cast<int16_t>(5)));
+		try
+		{
+			DataAggregate::stats<int32_t>(shop, "");
+		}
+		catch (std::exception& e)
+		{
+			std::cout << "WvłȂ: " << e.what() << std::endl;
+		}
+	}
+
 	return 0;
 }